@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dictionary {
+
+// Lector de bits sobre un bloque de memoria con un buffer de 64 bits.
+// Los bits se consumen MSB-primero (mismo orden que escribe el BitWriter del
+// encoder). Permite "asomarse" a N bits sin consumirlos, que es lo que necesita
+// la decodificación por tabla: un solo peek resuelve símbolo y longitud.
+class BitReader {
+public:
+    BitReader(const unsigned char* data, size_t size)
+        : data_(data), size_(size), pos_(0), buffer_(0), count_(0), consumed_(0) {}
+
+    // Garantiza al menos 57 bits válidos en el buffer. Más allá del final del
+    // payload se rellena con ceros; overrun() detecta si se llegaron a usar.
+    void refill() {
+        if (pos_ + 8 <= size_) {
+            // Camino rápido: carga 8 bytes de una vez. Los bits que se solapan
+            // con el contenido actual son idénticos, así que el OR es inocuo.
+            buffer_ |= loadBigEndian64(data_ + pos_) >> count_;
+            size_t bytes = static_cast<size_t>(63 - count_) >> 3;
+            pos_ += bytes;
+            count_ += static_cast<int>(bytes) * 8;
+            return;
+        }
+        while (count_ <= 56) {
+            uint64_t byte = pos_ < size_ ? data_[pos_] : 0;
+            ++pos_;
+            buffer_ |= byte << (56 - count_);
+            count_ += 8;
+        }
+    }
+
+    // Devuelve los siguientes n bits (1..32) sin consumirlos. Requiere refill().
+    uint32_t peek(int n) const {
+        return static_cast<uint32_t>(buffer_ >> (64 - n));
+    }
+
+    void consume(int n) {
+        buffer_ <<= n;
+        count_ -= n;
+        consumed_ += static_cast<uint64_t>(n);
+    }
+
+    // Lectura directa de n bits (1..32), para campos fuera de la tabla.
+    uint32_t readBits(int n) {
+        refill();
+        uint32_t value = peek(n);
+        consume(n);
+        return value;
+    }
+
+    // true si se consumieron más bits de los que realmente tenía el payload.
+    bool overrun() const { return consumed_ > static_cast<uint64_t>(size_) * 8; }
+
+    uint64_t bitsConsumed() const { return consumed_; }
+
+    // Bits del payload que quedan sin consumir (0 si ya se pasó del final).
+    uint64_t bitsLeft() const {
+        const uint64_t total = static_cast<uint64_t>(size_) * 8;
+        return consumed_ < total ? total - consumed_ : 0;
+    }
+
+private:
+    static uint64_t loadBigEndian64(const unsigned char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return __builtin_bswap64(v);
+#elif defined(__GNUC__)
+        return v;
+#else
+        uint64_t r = 0;
+        for (int i = 0; i < 8; ++i) r = (r << 8) | p[i];
+        return r;
+#endif
+    }
+
+    const unsigned char* data_;
+    size_t size_;
+    size_t pos_;        // siguiente byte a cargar en el buffer
+    uint64_t buffer_;   // bits pendientes alineados a la izquierda
+    int count_;         // cuántos bits del buffer son válidos
+    uint64_t consumed_; // bits consumidos en total
+};
+
+} // namespace dictionary
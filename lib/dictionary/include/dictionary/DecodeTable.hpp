@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "BitReader.hpp"
+
+namespace dictionary {
+
+// Un código Huffman ya convertido a entero: 'code' guarda los 'length' bits
+// (MSB-primero) y 'symbol' es el índice del símbolo en el diccionario.
+struct CodeEntry {
+    uint32_t code;
+    int length;
+    uint32_t symbol;
+};
+
+// Tabla de decodificación multi-bit. Con un peek de primaryBits() bits se
+// resuelve símbolo y longitud en una sola consulta; los códigos más largos que
+// la tabla primaria caen en una subtabla indexada por los bits restantes.
+class DecodeTable {
+public:
+    // Bits de la tabla primaria: 2^11 entradas caben holgadas en L1.
+    static constexpr int kMaxPrimaryBits = 11;
+    // Longitud máxima de código admitida (peek de 32 bits del BitReader).
+    static constexpr int kMaxCodeLength = 32;
+
+    DecodeTable();
+
+    // Construye la tabla; lanza std::runtime_error si hay códigos ambiguos
+    // (uno es prefijo de otro) o demasiado largos.
+    void build(const std::vector<CodeEntry>& entries);
+
+    bool empty() const { return entries_.empty(); }
+    int primaryBits() const { return primaryBits_; }
+    int maxLength() const { return maxLength_; }
+
+    // Decodifica un símbolo y lo consume del lector.
+    uint32_t decode(BitReader& reader) const {
+        reader.refill();
+        const Entry* e = &entries_[reader.peek(primaryBits_)];
+        if (e->subBits != 0) {
+            uint32_t bits = reader.peek(primaryBits_ + e->subBits);
+            e = &entries_[e->value + (bits & ((1u << e->subBits) - 1))];
+        }
+        if (e->length == 0) {
+            throw std::runtime_error("Código Huffman inválido en el payload del binario.");
+        }
+        reader.consume(e->length);
+        return e->value;
+    }
+
+private:
+    // length == 0 marca una entrada sin código. Si subBits != 0 la entrada es
+    // un enlace: 'value' es el desplazamiento de la subtabla dentro de entries_.
+    struct Entry {
+        uint32_t value = 0;
+        uint8_t length = 0;
+        uint8_t subBits = 0;
+    };
+
+    std::vector<Entry> entries_;
+    int primaryBits_;
+    int maxLength_;
+};
+
+} // namespace dictionary
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <istream>
+#include <ostream>
 #include <string>
 #include "Dictionary.hpp"
 
@@ -7,7 +10,26 @@ namespace dictionary {
 class Decoder {
 public:
     // Lee binario que incluye cabecera+diccionario+payload y regresa matriz textual.
-    static std::string decodeFile(const std::string& path, Dictionary& dict);
+    // Con threads != 1 y un binario con índice, decodifica los grupos de filas en
+    // paralelo (0 = todos los núcleos). Al terminar 'dict' queda con la última tabla.
+    static std::string decodeFile(const std::string& path, Dictionary& dict, size_t threads = 1);
+
+    // Como decodeFile, pero escribe el texto directo en 'outputPath' sin armarlo
+    // entero en memoria: en trozos grandes o, en paralelo, sobre el archivo
+    // proyectado con el tamaño que da el índice.
+    static void decodeToFile(const std::string& path, const std::string& outputPath, Dictionary& dict,
+                             size_t threads = 1);
+
+    // Decodifica lo que llega por 'in' (stdin, un pipe) sin volver atrás: un
+    // frame a la vez, y cada uno sale por 'out' apenas está decodificado. La
+    // memoria depende del tamaño de los frames, no del total. Acepta binarios
+    // de la versión 3 (sin usar su índice) y de flujo (huffman::comprimirFlujo).
+    static void decodeStream(std::istream& in, std::ostream& out, Dictionary& dict);
+
+    // Carga un archivo de tablas compartidas (comando train). Queda en memoria,
+    // ya compilado, para todos los binarios que se decodifiquen después y cuyos
+    // frames lo nombren por id y hash; se pueden cargar varios.
+    static void loadSharedTable(const std::string& path);
 
     // Guardar resultado en archivo
     static void writeText(const std::string& path, const std::string& text);
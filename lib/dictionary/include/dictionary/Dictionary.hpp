@@ -1,29 +1,42 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
+#include "DecodeTable.hpp"
 
 namespace dictionary {
 
-// Diccionario ligero: guarda pares codigo-binario -> simbolo decoded (como string).
-// Mantiene tambien los prefijos para validar mientras leemos bit a bit.
+// Diccionario ligero: guarda pares codigo-binario -> simbolo decoded.
+// Los simbolos son codepoints (enteros de 32 bits): se leen del binario una
+// vez por tabla y se decodifican sin pasar por texto.
 class Dictionary {
 private:
-    std::unordered_map<std::string, std::string> codes_;      // cod completo -> simbolo(s)
-    std::unordered_set<std::string> prefixes_;         // prefijos validos
+    std::unordered_map<std::string, uint32_t> codes_;  // cod completo -> codepoint
+    std::vector<uint32_t> symbols_;                    // codepoint por indice de la tabla
+    DecodeTable table_;                                // tabla multi-bit compilada
 
 public:
     Dictionary();
     ~Dictionary();
 
     // Inserta o actualiza un codigo Huffman con su simbolo asociado.
-    void insert(const std::string& code, const std::string& symbol);
-    // Busca el simbolo para un codigo completo; retorna false si no existe.
-    bool tryGetSymbol(const std::string& code, std::string& symbol) const;
-    // Indica si existe algun codigo que comience con este prefijo.
-    bool isValidPrefix(const std::string& prefix) const;
+    void insert(const std::string& code, uint32_t symbol);
     // Limpia cualquier contenido previo antes de volver a cargar desde un binario.
     void clear();
+
+    // Carga una tabla canonica: 'symbols' en orden canonico y 'lengthCounts[L]'
+    // = cantidad de codigos de longitud L. Reconstruye los codigos y compila
+    // la tabla de decodificacion directamente desde las longitudes, sin
+    // armar los codigos como texto.
+    void loadCanonical(const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& lengthCounts);
+
+    // Compila los codigos cargados en la tabla de decodificacion multi-bit.
+    // Debe llamarse una vez terminada la carga y antes de decodificar.
+    void buildDecodeTable();
+    const DecodeTable& decodeTable() const { return table_; }
+    // Simbolo asociado a cada indice que devuelve la tabla.
+    const std::vector<uint32_t>& symbols() const { return symbols_; }
 };
 
 } // namespace dictionary
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "huffman/Formato.hpp"
+
+namespace dictionary {
+
+// Lector de un stream rANS con kEstadosRANS estados intercalados (ver
+// huffman/Formato.hpp). Cada operación usa el estado que le toca por turno,
+// así que dos símbolos seguidos no dependen uno del otro hasta la
+// renormalización. Más allá del final del stream se leen ceros; overrun()
+// detecta si se llegaron a usar.
+class RansReader {
+public:
+    static constexpr uint32_t kStates = huffman::formato::kEstadosRANS;
+    static constexpr uint32_t kLower = huffman::formato::kCotaRANS;
+
+    RansReader(const unsigned char* data, size_t size) : p_(data), end_(data + size) {
+        for (uint32_t k = 0; k < kStates; ++k) {
+            uint32_t x = 0;
+            for (int b = 0; b < 4; ++b) {
+                x |= static_cast<uint32_t>(nextByte()) << (8 * b);
+            }
+            // Un estado bajo la cota no termina nunca de renormalizar
+            if (x < kLower) {
+                throw std::runtime_error("Estado rANS inválido en el payload del binario.");
+            }
+            states_[k] = x;
+        }
+    }
+
+    // Slot del estado actual dentro de 2^bits ('mask' = 2^bits - 1).
+    uint32_t slot(uint32_t mask) const { return states_[current_] & mask; }
+
+    // Consume la operación de frecuencia 'freq' en la que el slot actual está
+    // a 'offset' de su primer slot y pasa al estado siguiente.
+    void advance(uint32_t offset, uint32_t freq, int scaleBits) {
+        uint32_t x = states_[current_];
+        x = freq * (x >> scaleBits) + offset;
+        if (end_ - p_ >= 4) {
+            // Camino rápido sin saltos: cuántos bytes faltan depende del dato
+            // y un bucle fallaría la predicción a cada rato. Con x >= 2 nunca
+            // son más de 3.
+            const uint32_t n = (x < kLower) + (x < (kLower >> 8)) + (x < (kLower >> 16));
+            const uint64_t next = loadBigEndian32(p_);
+            x = static_cast<uint32_t>((uint64_t(x) << (8 * n)) | (next >> (32 - 8 * n)));
+            p_ += n;
+        } else {
+            while (x < kLower) {
+                x = (x << 8) | nextByte();
+            }
+        }
+        states_[current_] = x;
+        current_ = (current_ + 1) % kStates;
+    }
+
+    // Lee n bits extra (0..32) en tramos de a lo sumo kBitsCrudosRANS.
+    uint32_t readBits(int n) {
+        uint32_t value = 0;
+        while (n > 0) {
+            const int chunk = n < static_cast<int>(huffman::formato::kBitsCrudosRANS)
+                ? n : static_cast<int>(huffman::formato::kBitsCrudosRANS);
+            const uint32_t bits = slot((1u << chunk) - 1);
+            advance(0, 1, chunk);
+            value = (value << chunk) | bits;
+            n -= chunk;
+        }
+        return value;
+    }
+
+    // true si se leyeron bytes más allá del final del stream.
+    bool overrun() const { return p_ > end_; }
+
+    // Un stream bien formado termina con todos los estados en la cota y
+    // exactamente al final de sus bytes.
+    bool finished() const {
+        for (uint32_t k = 0; k < kStates; ++k) {
+            if (states_[k] != kLower) {
+                return false;
+            }
+        }
+        return p_ == end_;
+    }
+
+private:
+    static uint32_t loadBigEndian32(const unsigned char* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return __builtin_bswap32(v);
+#else
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+#endif
+    }
+
+    uint32_t nextByte() {
+        uint32_t byte = p_ < end_ ? *p_ : 0;
+        ++p_;
+        return byte;
+    }
+
+    const unsigned char* p_;
+    const unsigned char* end_;
+    uint32_t states_[kStates];
+    uint32_t current_ = 0;
+};
+
+} // namespace dictionary
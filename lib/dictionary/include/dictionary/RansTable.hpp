@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RansReader.hpp"
+
+namespace dictionary {
+
+// Tabla de decodificación rANS: para cada slot de 2^scaleBits, el símbolo que
+// lo ocupa, su frecuencia y la distancia a su primer slot. Todo sale de una
+// consulta por slot, así que el estado siguiente no espera a otra tabla.
+class RansTable {
+public:
+    // Carga la tabla con los símbolos en el orden de sus slots; lanza
+    // std::runtime_error si las frecuencias no suman exactamente 2^scaleBits.
+    void load(const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& freqs, int scaleBits);
+    void clear();
+
+    bool empty() const { return symbols_.empty(); }
+    // Codepoint (o clase de racha) de cada índice que devuelve decode().
+    const std::vector<uint32_t>& symbols() const { return symbols_; }
+
+    // Decodifica un símbolo con el estado que le toca al lector.
+    uint32_t decode(RansReader& reader) const {
+        const Slot& slot = slots_[reader.slot(mask_)];
+        reader.advance(slot.offset, slot.freq, scaleBits_);
+        return slot.symbol;
+    }
+
+private:
+    struct Slot {
+        uint32_t symbol;   // índice en symbols_
+        uint32_t freq;
+        uint32_t offset;   // slot - primer slot del símbolo
+    };
+
+    std::vector<uint32_t> symbols_;
+    std::vector<Slot> slots_;
+    int scaleBits_ = 0;
+    uint32_t mask_ = 0;
+};
+
+} // namespace dictionary
@@ -0,0 +1,70 @@
+#include "dictionary/DecodeTable.hpp"
+#include <algorithm>
+
+using namespace dictionary;
+
+DecodeTable::DecodeTable() : primaryBits_(0), maxLength_(0) {}
+
+// Rellena la tabla primaria con los códigos cortos y crea una subtabla por cada
+// prefijo de primaryBits_ bits que tenga códigos más largos.
+void DecodeTable::build(const std::vector<CodeEntry>& codes) {
+    entries_.clear();
+    maxLength_ = 0;
+    for (const auto& c : codes) {
+        if (c.length <= 0 || c.length > kMaxCodeLength) {
+            throw std::runtime_error("Longitud de código Huffman fuera de rango para la tabla de decodificación.");
+        }
+        if (c.length < 32 && (c.code >> c.length) != 0) {
+            throw std::runtime_error("Código Huffman con bits fuera de su longitud.");
+        }
+        maxLength_ = std::max(maxLength_, c.length);
+    }
+    if (codes.empty()) {
+        primaryBits_ = 0;
+        return;
+    }
+
+    primaryBits_ = std::min(maxLength_, kMaxPrimaryBits);
+    const uint32_t primarySize = 1u << primaryBits_;
+
+    // Para cada prefijo primario, la longitud máxima de los códigos que cuelgan de él.
+    std::vector<int> longest(primarySize, 0);
+    for (const auto& c : codes) {
+        if (c.length > primaryBits_) {
+            uint32_t prefix = c.code >> (c.length - primaryBits_);
+            longest[prefix] = std::max(longest[prefix], c.length);
+        }
+    }
+
+    entries_.resize(primarySize);
+    for (uint32_t p = 0; p < primarySize; ++p) {
+        if (longest[p] == 0) continue;
+        int subBits = longest[p] - primaryBits_;
+        entries_[p].value = static_cast<uint32_t>(entries_.size());
+        entries_[p].subBits = static_cast<uint8_t>(subBits);
+        entries_.resize(entries_.size() + (size_t(1) << subBits));
+    }
+
+    auto fill = [this](size_t first, size_t count, uint32_t symbol, int length) {
+        for (size_t i = first; i < first + count; ++i) {
+            if (entries_[i].length != 0 || entries_[i].subBits != 0) {
+                throw std::runtime_error("Diccionario con códigos ambiguos: un código es prefijo de otro.");
+            }
+            entries_[i].value = symbol;
+            entries_[i].length = static_cast<uint8_t>(length);
+        }
+    };
+
+    for (const auto& c : codes) {
+        if (c.length <= primaryBits_) {
+            int pad = primaryBits_ - c.length;
+            fill(size_t(c.code) << pad, size_t(1) << pad, c.symbol, c.length);
+        } else {
+            int rest = c.length - primaryBits_;
+            const Entry& link = entries_[c.code >> rest];
+            uint32_t suffix = c.code & ((1u << rest) - 1);
+            int pad = link.subBits - rest;
+            fill(link.value + (size_t(suffix) << pad), size_t(1) << pad, c.symbol, c.length);
+        }
+    }
+}
@@ -1,23 +1,134 @@
 #include "dictionary/Decoder.hpp"
+#include "dictionary/BitReader.hpp"
+#include "dictionary/RansTable.hpp"
+#include "huffman/Formato.hpp"
+#include "huffman/PoolHilos.hpp"
+#include <algorithm>
+#include <deque>
 #include <fstream>
-#include <sstream>
+#include <istream>
+#include <ostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define DECODER_USA_MMAP 1
+#endif
 
 using namespace dictionary;
 
 namespace {
 
 // Encapsula la cabecera estándar del .bin (dimensiones y tamaño del diccionario).
+// En los binarios versionados 'version' indica el formato (0 = original).
 struct BinaryHeader {
     int rows = 0;
     int cols = 0;
     int dictSize = 0;
+    int version = 0;
+    int flags = 0;
+    int maxCodeLength = 0;    // 0 si la cabecera no lo declara
+    uint32_t background = 0;  // solo con rachas de fondo
+    uint64_t indexOffset = 0; // 0 si el archivo no trae índice
+};
+
+// Versiones con frames (la 3 y la de flujo).
+bool hasFrames(const BinaryHeader& header) {
+    return header.version == huffman::formato::kVersionBloques || header.version == huffman::formato::kVersionFlujo;
+}
+
+// Entradas del índice de la versión 3 (ver huffman/Formato.hpp).
+struct IndexGroup {
+    uint64_t firstRow = 0;
+    uint64_t firstBit = 0;
+    uint64_t symbols = 0;
+    uint64_t outBytes = 0;
+};
+
+struct IndexFrame {
+    uint64_t offset = 0;
+    uint64_t rows = 0;
+    std::vector<IndexGroup> groups;
+};
+
+// Índice de símbolo que la tabla nunca devuelve.
+constexpr uint32_t kNoSymbol = 0xFFFFFFFFu;
+
+// Una de las tablas de un frame, con lo que hace falta por símbolo. Con rANS
+// la tabla va en 'rans' y 'dict' queda vacío.
+struct FrameTable {
+    Dictionary dict;
+    RansTable rans;
+    std::vector<std::string> utf8;
+    std::vector<uint8_t> next;       // tabla para lo que sigue a cada símbolo (contextos)
+    uint32_t rowEnd = kNoSymbol;     // símbolo de fin de fila (filas irregulares)
+    uint32_t runSymbol = kNoSymbol;  // símbolo de fondo que abre una racha
+};
+
+// Streams de un grupo de filas dentro del payload de un frame: uno con rANS,
+// kStreamsIntercalados con Huffman intercalado.
+struct StreamGroup {
+    uint64_t rows = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;       // todos sus streams
+    uint64_t streams[huffman::formato::kStreamsIntercalados] = {};  // bytes de cada uno (intercalado)
+};
+
+// Lo que representa un código de un frame LZ77: un literal ya en UTF-8
+// ('size' bytes) o, con 'size' == 0, una clase de largo o de distancia.
+struct LzCode {
+    uint32_t base = 0;
+    uint8_t extra = 0;       // bits extra de la clase
+    uint8_t size = 0;
+    char utf8[4] = {};
+};
+
+// Grupo de filas de un frame LZ77 y los bytes de texto que salen de él.
+struct LzGroup {
+    uint64_t rows = 0;
+    uint64_t textBytes = 0;
+};
+
+// Un frame ya leído del disco, listo para decodificar cualquiera de sus grupos.
+// Sin tablas de contexto tiene una sola tabla. Un frame kFrameCompartido no
+// copia la tabla: 'shared' apunta a la cargada y 'tables' queda vacío.
+struct LoadedFrame {
+    std::vector<FrameTable> tables;
+    std::shared_ptr<const FrameTable> shared;
+    uint8_t firstTable = 0;          // tabla con la que empieza cada fila
+    Dictionary runs;                 // clases de largo de racha (rachas de fondo)
+    RansTable ransRuns;              // lo mismo con rANS
+    bool rans = false;
+    std::vector<StreamGroup> groups; // vacío sin rANS ni streams intercalados
+    // Solo en frames kFrameLZ: la tabla de literales es la de tables[0]
+    bool lz = false;
+    Dictionary distances;
+    std::vector<LzCode> lzLiterals;
+    std::vector<LzCode> lzDistances;
+    std::vector<LzGroup> lzGroups;
+    // Solo en frames kFrameBWT: tables[0] tiene los símbolos MTF en 'dict' y
+    // el alfabeto del bloque en 'utf8'
+    bool bwt = false;
+    uint64_t bwtLength = 0;
+    std::vector<uint32_t> bwtPoints;    // el primero es la fila del centinela
+    std::vector<unsigned char> payload;
+
+    size_t numTables() const { return shared ? 1 : tables.size(); }
+    const FrameTable& table(size_t k) const { return shared ? *shared : tables[k]; }
 };
 
 // Lee un entero de 32 bits del stream y valida que exista suficiente data.
-int readInt(std::ifstream& in) {
+int readInt(std::istream& in) {
     int value = 0;
     if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
         throw std::runtime_error("Archivo .bin incompleto al leer enteros.");
@@ -25,8 +136,55 @@ int readInt(std::ifstream& in) {
     return value;
 }
 
+// Lee un entero LEB128 sin signo (ver huffman/Formato.hpp).
+uint64_t readVarint(std::istream& in) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) {
+            throw std::runtime_error("Archivo .bin incompleto al leer la cabecera.");
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Entero variable demasiado largo en la cabecera.");
+}
+
+// Lee un varint y valida que quepa en un int no negativo.
+int readVarintInt(std::istream& in) {
+    uint64_t value = readVarint(in);
+    if (value > 0x7FFFFFFF) {
+        throw std::runtime_error("Valor fuera de rango en la cabecera del binario.");
+    }
+    return static_cast<int>(value);
+}
+
+// Entero de 8 bytes little-endian (posición del índice).
+uint64_t readU64(std::istream& in) {
+    unsigned char bytes[8];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        throw std::runtime_error("Archivo .bin incompleto al leer la cabecera.");
+    }
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Entero de 4 bytes little-endian (hash de una tabla compartida).
+uint32_t readU32(std::istream& in) {
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        throw std::runtime_error("Archivo .bin incompleto al leer un frame.");
+    }
+    return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
 // Cada string se codifica como: <int longitud><bytes>. Esta función lo reconstruye.
-std::string readString(std::ifstream& in) {
+std::string readString(std::istream& in) {
     int len = readInt(in);
     if (len < 0) {
         throw std::runtime_error("Longitud negativa detectada en cadena del diccionario.");
@@ -38,29 +196,51 @@ std::string readString(std::ifstream& in) {
     return s;
 }
 
-// Lector de bits perezoso: amortiza lecturas byte a byte del payload.
-class BitReader {
-public:
-    explicit BitReader(std::ifstream& stream) : in(stream), bitIndex(8), buffer(0) {}
+// Carga en memoria el resto del archivo (el payload de bits) desde la posición actual.
+std::vector<unsigned char> readPayload(std::istream& in) {
+    std::streampos start = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(start);
+    if (start < 0 || end < start) {
+        throw std::runtime_error("No se pudo determinar el tamaño del payload.");
+    }
+    std::vector<unsigned char> payload(static_cast<size_t>(end - start));
+    if (!payload.empty() && !in.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()))) {
+        throw std::runtime_error("Archivo .bin incompleto al leer payload.");
+    }
+    return payload;
+}
 
-    // Devuelve 0/1 o -1 en EOF
-    int readBit() {
-        if (bitIndex == 8) {
-            if (!in.read(reinterpret_cast<char*>(&buffer), 1)) {
-                return -1;
+// Lee exactamente 'size' bytes (el payload de un frame).
+std::vector<unsigned char> readBytes(std::istream& in, uint64_t size) {
+    std::streampos start = in.tellg();
+    if (start < 0) {
+        // Un pipe no dice cuánto queda: se lee por trozos, así un tamaño
+        // inválido no reserva memoria por adelantado
+        constexpr uint64_t kChunk = uint64_t(1) << 20;
+        std::vector<unsigned char> bytes;
+        while (bytes.size() < size) {
+            const size_t have = bytes.size();
+            bytes.resize(have + static_cast<size_t>(std::min(kChunk, size - have)));
+            if (!in.read(reinterpret_cast<char*>(bytes.data() + have), static_cast<std::streamsize>(bytes.size() - have))) {
+                throw std::runtime_error("Archivo .bin incompleto al leer payload.");
             }
-            bitIndex = 0;
         }
-        int bit = (buffer >> (7 - bitIndex)) & 1;
-        ++bitIndex;
-        return bit;
+        return bytes;
     }
-
-private:
-    std::ifstream& in;
-    int bitIndex;
-    unsigned char buffer;
-};
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(start);
+    if (start < 0 || static_cast<uint64_t>(end - start) < size) {
+        throw std::runtime_error("Archivo .bin incompleto al leer payload.");
+    }
+    std::vector<unsigned char> bytes(static_cast<size_t>(size));
+    if (!bytes.empty() && !in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("Archivo .bin incompleto al leer payload.");
+    }
+    return bytes;
+}
 
 // Convierte un codepoint Unicode a UTF-8 y lo concatena al string de salida.
 void appendUtf8(std::string& out, uint32_t cp) {
@@ -83,13 +263,9 @@ void appendUtf8(std::string& out, uint32_t cp) {
     }
 }
 
-// Los símbolos almacenados en el diccionario son enteros en texto (codepoints).
-// Esta función los traduce nuevamente a caracteres UTF-8.
-std::string tokenToUtf8(const std::string& token) {
-    if (token.empty()) {
-        return "";
-    }
-
+// El diccionario del formato original guarda los codepoints como texto
+// decimal; se convierten a entero una sola vez, al cargar la tabla.
+uint32_t tokenToCodepoint(const std::string& token) {
     size_t consumed = 0;
     long long value = 0;
     try {
@@ -104,35 +280,923 @@ std::string tokenToUtf8(const std::string& token) {
     if (value < 0 || value > 0x10FFFF) {
         throw std::runtime_error("Codepoint fuera de rango en el payload decodificado.");
     }
+    return static_cast<uint32_t>(value);
+}
 
-    std::string utf8;
-    appendUtf8(utf8, static_cast<uint32_t>(value));
+// Traduce cada símbolo de la tabla a UTF-8 una sola vez, no por celda.
+std::vector<std::string> symbolsToUtf8(const std::vector<uint32_t>& symbols) {
+    std::vector<std::string> utf8(symbols.size());
+    for (size_t i = 0; i < utf8.size(); ++i) {
+        appendUtf8(utf8[i], symbols[i]);
+    }
     return utf8;
 }
 
-// Reconstruye la matriz textual en formato legible (filas separadas por '\n').
-std::string formatMatrix(const std::vector<std::string>& tokens, int rows, int cols) {
-    if (rows == 0 || cols == 0) {
-        return "";
+// Copia 'count' veces el carácter 'bytes' a partir de 'dst'.
+void fill(char* dst, const std::string& bytes, size_t count) {
+    if (bytes.size() == 1) {
+        std::memset(dst, bytes[0], count);
+        return;
     }
-    std::ostringstream oss;
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            size_t idx = static_cast<size_t>(i) * static_cast<size_t>(cols) + static_cast<size_t>(j);
-            if (idx >= tokens.size()) {
-                throw std::runtime_error("Cantidad de tokens insuficiente para reconstruir la matriz.");
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(dst + i * bytes.size(), bytes.data(), bytes.size());
+    }
+}
+
+// Destinos de la salida decodificada: reciben los bytes UTF-8 ya calculados
+// de cada símbolo. Las funciones de decodificación son plantillas sobre el
+// destino para no pagar una llamada virtual por celda.
+
+// Todo el texto en memoria (decodeFile).
+class StringSink {
+public:
+    explicit StringSink(std::string& out) : out_(out) {}
+    void put(char c) { out_.push_back(c); }
+    void append(const std::string& bytes) { out_ += bytes; }
+    void append(const char* bytes, size_t size) { out_.append(bytes, size); }
+    void endFrame() {}
+    void repeat(const std::string& bytes, uint64_t count) {
+        if (bytes.size() == 1) {
+            out_.append(static_cast<size_t>(count), bytes[0]);
+            return;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            out_ += bytes;
+        }
+    }
+
+private:
+    std::string& out_;
+};
+
+// Archivo escrito en trozos grandes (decodeToFile): la salida nunca está
+// entera en memoria. Hay que llamar a flush() al terminar. Con 'eachFrame'
+// (decodeStream) además se vacía al terminar cada frame.
+class FileSink {
+public:
+    explicit FileSink(std::ostream& out, bool eachFrame = false)
+        : out_(out), buffer_(kChunkSize), eachFrame_(eachFrame) {}
+    void put(char c) {
+        if (used_ == buffer_.size()) {
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+    // 'bytes' es un carácter UTF-8: a lo sumo 4 bytes.
+    void append(const std::string& bytes) {
+        if (buffer_.size() - used_ < bytes.size()) {
+            flush();
+        }
+        std::memcpy(&buffer_[used_], bytes.data(), bytes.size());
+        used_ += bytes.size();
+    }
+    void append(const char* bytes, size_t size) {
+        if (buffer_.size() - used_ < size) {
+            flush();
+        }
+        if (size >= buffer_.size()) {
+            out_.write(bytes, static_cast<std::streamsize>(size));
+            return;
+        }
+        std::memcpy(&buffer_[used_], bytes, size);
+        used_ += size;
+    }
+    void repeat(const std::string& bytes, uint64_t count) {
+        while (count > 0) {
+            if (buffer_.size() - used_ < bytes.size()) {
+                flush();
             }
-            oss << tokenToUtf8(tokens[idx]);
+            size_t fit = std::min<uint64_t>((buffer_.size() - used_) / bytes.size(), count);
+            fill(&buffer_[used_], bytes, fit);
+            used_ += fit * bytes.size();
+            count -= fit;
+        }
+    }
+    void flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+    void endFrame() {
+        if (eachFrame_) {
+            flush();
+            out_.flush();
         }
-        if (i + 1 < rows) {
-            oss << '\n';
+    }
+
+private:
+    static constexpr size_t kChunkSize = size_t(1) << 20;
+    std::ostream& out_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    bool eachFrame_ = false;
+};
+
+// Tramo [begin, end) de una salida ya dimensionada (decodificación en
+// paralelo). Escribir fuera del tramo significa que el índice no coincide con
+// el payload.
+class SpanSink {
+public:
+    SpanSink(char* begin, char* end) : p_(begin), end_(end) {}
+    void put(char c) {
+        if (p_ == end_) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
         }
+        *p_++ = c;
+    }
+    void append(const std::string& bytes) {
+        reserve(bytes.size(), 1);
+        std::memcpy(p_, bytes.data(), bytes.size());
+        p_ += bytes.size();
+    }
+    void append(const char* bytes, size_t size) {
+        reserve(1, size);
+        std::memcpy(p_, bytes, size);
+        p_ += size;
+    }
+    void repeat(const std::string& bytes, uint64_t count) {
+        reserve(bytes.size(), count);
+        fill(p_, bytes, static_cast<size_t>(count));
+        p_ += count * bytes.size();
     }
-    return oss.str();
+    bool full() const { return p_ == end_; }
+
+private:
+    void reserve(size_t size, uint64_t count) {
+        if (static_cast<uint64_t>(end_ - p_) / size < count) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+    }
+
+    char* p_;
+    char* const end_;
+};
+
+// Lo último que salió de un grupo LZ77, de donde leen las copias. El buffer
+// guarda hasta dos ventanas: al llenarse pasa al sink todo salvo la última,
+// así que la memoria no depende del tamaño del grupo. Hay que llamar a
+// finish() al terminar el grupo.
+template <class Sink>
+class LzHistory {
+public:
+    static constexpr size_t kWindow = huffman::formato::kVentanaLZ;
+
+    LzHistory(Sink& out, std::vector<char>& buffer) : out_(out), buffer_(buffer) {
+        buffer_.resize(2 * kWindow);
+    }
+
+    // Bytes producidos en el grupo hasta ahora.
+    uint64_t written() const { return written_; }
+
+    // 'size' es a lo sumo 4 (un carácter UTF-8).
+    void literal(const char* bytes, size_t size) {
+        if (buffer_.size() - used_ < size) {
+            slide();
+        }
+        std::memcpy(&buffer_[used_], bytes, size);
+        used_ += size;
+        written_ += size;
+    }
+
+    // Requiere 1 <= distance <= min(written(), kWindow). Con distance <
+    // length la copia lee lo que ella misma va escribiendo.
+    void copy(size_t distance, uint64_t length) {
+        while (length > 0) {
+            if (used_ == buffer_.size()) {
+                slide();
+            }
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(length, buffer_.size() - used_));
+            char* dst = &buffer_[used_];
+            const char* src = dst - distance;
+            if (distance >= n) {
+                std::memcpy(dst, src, n);
+            } else if (distance == 1) {
+                std::memset(dst, *src, n);
+            } else {
+                for (size_t i = 0; i < n; ++i) {
+                    dst[i] = src[i];
+                }
+            }
+            used_ += n;
+            written_ += n;
+            length -= n;
+        }
+    }
+
+    void finish() {
+        out_.append(buffer_.data(), used_);
+        used_ = 0;
+    }
+
+private:
+    // Solo con el buffer casi lleno: siempre queda al menos una ventana.
+    void slide() {
+        const size_t drop = used_ - kWindow;
+        out_.append(buffer_.data(), drop);
+        std::memmove(buffer_.data(), buffer_.data() + drop, kWindow);
+        used_ = kWindow;
+    }
+
+    Sink& out_;
+    std::vector<char>& buffer_;
+    size_t used_ = 0;
+    uint64_t written_ = 0;
+};
+
+// Salida de tamaño conocido de antemano (el del índice), proyectada en
+// memoria para que cada hilo escriba su tramo directamente en el archivo.
+// Sin mmap usa un buffer y lo escribe de una vez en finish().
+class MappedOutput {
+public:
+    MappedOutput(const std::string& path, size_t size) : path_(path), size_(size) {
+#ifdef DECODER_USA_MMAP
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("No se pudo crear archivo de salida.");
+        }
+        if (size_ == 0) {
+            mapped_ = true;
+            return;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(size_)) == 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<char*>(p);
+                mapped_ = true;
+                return;
+            }
+        }
+#endif
+        buffer_.resize(size_);
+        data_ = buffer_.data();
+    }
+    ~MappedOutput() { release(); }
+    MappedOutput(const MappedOutput&) = delete;
+    MappedOutput& operator=(const MappedOutput&) = delete;
+
+    char* data() { return data_; }
+
+    // Saca del proceso las páginas ya escritas de [0, bytes): siguen sucias en
+    // la caché del sistema y se guardan igual, pero la memoria residente deja
+    // de crecer con el tamaño de la salida.
+    void discard(size_t bytes) {
+#ifdef DECODER_USA_MMAP
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t end = bytes / page * page;
+        if (mapped_ && data_ != nullptr && end > discarded_) {
+            ::madvise(data_ + discarded_, end - discarded_, MADV_DONTNEED);
+            discarded_ = end;
+        }
+#else
+        (void)bytes;
+#endif
+    }
+
+    // Termina de escribir el archivo; lanza si falla.
+    void finish() {
+        bool ok = true;
+        if (!mapped_) {
+            std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+            out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            ok = static_cast<bool>(out);
+        }
+        if (!release() || !ok) {
+            throw std::runtime_error("Error escribiendo el archivo de salida.");
+        }
+    }
+
+private:
+    bool release() {
+        bool ok = true;
+#ifdef DECODER_USA_MMAP
+        if (data_ != nullptr && mapped_) {
+            ok = ::munmap(data_, size_) == 0;
+        }
+        if (fd_ >= 0) {
+            ok = ::close(fd_) == 0 && ok;
+            fd_ = -1;
+        }
+#endif
+        data_ = nullptr;
+        return ok;
+    }
+
+    std::string path_;
+    size_t size_;
+    char* data_ = nullptr;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+#ifdef DECODER_USA_MMAP
+    int fd_ = -1;
+    size_t discarded_ = 0;
+#endif
+};
+
+// Índice en la tabla del codepoint 'cp', o kNoSymbol si la tabla no lo tiene.
+uint32_t findSymbol(const std::vector<uint32_t>& symbols, uint32_t cp) {
+    auto it = std::find(symbols.begin(), symbols.end(), cp);
+    return it != symbols.end() ? static_cast<uint32_t>(it - symbols.begin()) : kNoSymbol;
+}
+
+// Lee el largo de una racha de fondo: su clase en la tabla de rachas y los
+// bits extra (ver huffman/Formato.hpp).
+uint64_t readRun(const LoadedFrame& frame, BitReader& bitReader) {
+    const DecodeTable& table = frame.runs.decodeTable();
+    if (table.empty()) {
+        throw std::runtime_error("Racha de fondo sin tabla de largos en el binario.");
+    }
+    const uint32_t runClass = frame.runs.symbols()[table.decode(bitReader)];
+    uint64_t length = uint64_t(1) << runClass;
+    if (runClass > 0) {
+        length += bitReader.readBits(static_cast<int>(runClass));
+    }
+    return length;
+}
+
+// Fuentes de símbolos para decodeRows: cada una sabe qué tabla usar de un
+// FrameTable y cómo leer símbolos y largos de racha de su payload.
+
+// Códigos Huffman sobre un BitReader.
+struct HuffmanSource {
+    using Table = DecodeTable;
+    const LoadedFrame& frame;
+    BitReader& bits;
+
+    static const DecodeTable& table(const FrameTable& t) { return t.dict.decodeTable(); }
+    uint32_t decode(const DecodeTable& table) { return table.decode(bits); }
+    uint64_t run() { return readRun(frame, bits); }
+    bool overrun() const { return bits.overrun(); }
+};
+
+// Códigos Huffman repartidos por turno entre los streams de un grupo, un
+// BitReader por stream. Cada código avanza un solo lector, así que el
+// siguiente no espera a conocer su longitud.
+struct InterleavedSource {
+    static constexpr uint32_t kStreams = huffman::formato::kStreamsIntercalados;
+    using Table = DecodeTable;
+    const LoadedFrame& frame;
+    BitReader* readers;
+    uint32_t current = 0;
+
+    static const DecodeTable& table(const FrameTable& t) { return t.dict.decodeTable(); }
+    uint32_t decode(const DecodeTable& table) {
+        uint32_t symbol = table.decode(readers[current]);
+        current = (current + 1) % kStreams;
+        return symbol;
+    }
+    // La clase de la racha y sus bits extra vienen del mismo stream.
+    uint64_t run() {
+        uint64_t length = readRun(frame, readers[current]);
+        current = (current + 1) % kStreams;
+        return length;
+    }
+    // Solo el último lector usado: en una fila mal formada cada uno vuelve a
+    // revisarse a los kStreams códigos. Al terminar hay que usar allOverrun().
+    bool overrun() const { return readers[(current + kStreams - 1) % kStreams].overrun(); }
+    bool allOverrun() const {
+        bool any = false;
+        for (uint32_t k = 0; k < kStreams; ++k) {
+            any |= readers[k].overrun();
+        }
+        return any;
+    }
+};
+
+// Un stream rANS de un grupo de filas.
+struct RansSource {
+    using Table = RansTable;
+    const LoadedFrame& frame;
+    RansReader& reader;
+
+    static const RansTable& table(const FrameTable& t) { return t.rans; }
+    uint32_t decode(const RansTable& table) { return table.decode(reader); }
+    uint64_t run() {
+        if (frame.ransRuns.empty()) {
+            throw std::runtime_error("Racha de fondo sin tabla de largos en el binario.");
+        }
+        const uint32_t runClass = frame.ransRuns.symbols()[frame.ransRuns.decode(reader)];
+        uint64_t length = uint64_t(1) << runClass;
+        if (runClass > 0) {
+            length += reader.readBits(static_cast<int>(runClass));
+        }
+        return length;
+    }
+    bool overrun() const { return reader.overrun(); }
+};
+
+// Decodifica 'rows' filas del frame desde 'source' y las agrega a 'out'
+// separadas por '\n', sin guardar las celdas: cada símbolo pasa directo a sus
+// bytes UTF-8 ya calculados. Con 'ragged' cada fila termina en el fin de fila;
+// si no, tiene 'cols' celdas. Con kContexts cada símbolo elige la tabla del
+// siguiente. 'firstRow' indica si estas son las primeras filas (sin '\n'
+// delante). Devuelve las celdas decodificadas.
+template <bool kContexts, class Source, class Sink>
+uint64_t decodeRowsWith(Sink& out, const LoadedFrame& frame, Source& source, uint64_t rows, int cols,
+                        bool ragged, bool firstRow) {
+    const uint64_t width = static_cast<uint64_t>(cols);
+    uint64_t cells = 0;
+    for (uint64_t i = 0; i < rows; ++i) {
+        if (i > 0 || !firstRow) {
+            out.put('\n');
+        }
+        // Lo de la tabla actual va en variables locales: las escrituras de
+        // bytes en 'out' no obligan a releerlo de memoria en cada celda
+        const typename Source::Table* table = nullptr;
+        const std::string* utf8 = nullptr;
+        const uint8_t* next = nullptr;
+        uint32_t rowEnd = kNoSymbol;
+        uint32_t runSymbol = kNoSymbol;
+        auto select = [&](const FrameTable& t) {
+            table = &Source::table(t);
+            utf8 = t.utf8.data();
+            next = t.next.data();
+            rowEnd = t.rowEnd;
+            runSymbol = t.runSymbol;
+        };
+        select(frame.table(frame.firstTable));
+
+        uint64_t j = 0;
+        auto emit = [&](uint32_t symbol) {
+            if (symbol == runSymbol) {
+                uint64_t length = source.run();
+                if (length > width - std::min(j, width)) {
+                    throw std::runtime_error("Racha de fondo más larga que la fila en el binario.");
+                }
+                out.repeat(utf8[symbol], length);
+                j += length;
+            } else {
+                out.append(utf8[symbol]);
+                ++j;
+            }
+            if (kContexts) {
+                select(frame.table(next[symbol]));
+            }
+        };
+        if (ragged) {
+            for (uint32_t symbol = source.decode(*table); symbol != rowEnd; symbol = source.decode(*table)) {
+                if (source.overrun()) {
+                    throw std::runtime_error("Archivo binario incompleto al leer payload.");
+                }
+                emit(symbol);
+            }
+        } else {
+            while (j < width) {
+                emit(source.decode(*table));
+            }
+        }
+        cells += j;
+    }
+    if (source.overrun()) {
+        throw std::runtime_error("Archivo binario incompleto al leer payload.");
+    }
+    return cells;
+}
+
+template <class Source, class Sink>
+uint64_t decodeRows(Sink& out, const LoadedFrame& frame, Source& source, uint64_t rows, int cols,
+                    bool ragged, bool firstRow) {
+    if (rows == 0 || (!ragged && cols == 0)) {
+        return 0;
+    }
+    if (frame.numTables() == 0) {
+        throw std::runtime_error("Diccionario vacío o inválido en el binario.");
+    }
+    for (size_t k = 0; k < frame.numTables(); ++k) {
+        if (Source::table(frame.table(k)).empty()) {
+            throw std::runtime_error("Diccionario vacío o inválido en el binario.");
+        }
+    }
+    if (frame.numTables() > 1) {
+        return decodeRowsWith<true>(out, frame, source, rows, cols, ragged, firstRow);
+    }
+    return decodeRowsWith<false>(out, frame, source, rows, cols, ragged, firstRow);
+}
+
+// Decodifica las filas de un grupo rANS desde su propio stream y verifica
+// que el stream termine justo donde debe. Devuelve las celdas decodificadas.
+template <class Sink>
+uint64_t decodeRansGroup(Sink& out, const LoadedFrame& frame, const StreamGroup& group, int cols, bool ragged,
+                         bool firstRow) {
+    RansReader reader(frame.payload.data() + group.offset, static_cast<size_t>(group.size));
+    RansSource source{frame, reader};
+    uint64_t cells = decodeRows(out, frame, source, group.rows, cols, ragged, firstRow);
+    if (!reader.finished()) {
+        throw std::runtime_error("Stream rANS inconsistente en el payload del binario.");
+    }
+    return cells;
+}
+
+// Caso común de los streams intercalados: una sola tabla y sin rachas, así
+// que cada código es un símbolo de esa tabla. Mientras a cada stream le quede
+// al menos un código entero, los próximos kStreams códigos son uno por
+// lector y se decodifican juntos, sin que ninguno espere la longitud del
+// anterior; el resto va de a uno. Devuelve las celdas decodificadas.
+template <class Sink>
+uint64_t decodeInterleavedPlain(Sink& out, const FrameTable& table, BitReader* readers, uint64_t rows, int cols,
+                                bool ragged, bool firstRow) {
+    const DecodeTable& codes = table.dict.decodeTable();
+    const std::string* utf8 = table.utf8.data();
+    const uint32_t rowEnd = ragged ? table.rowEnd : kNoSymbol;
+    const uint64_t width = ragged ? UINT64_MAX : static_cast<uint64_t>(cols);
+    // Un código completo más el relleno del último byte
+    const uint64_t safeBits = static_cast<uint64_t>(codes.maxLength()) + 8;
+    uint64_t row = 0;
+    uint64_t j = 0;
+    uint64_t cells = 0;
+    if (!firstRow) {
+        out.put('\n');
+    }
+    // Devuelve true al terminar la última fila del grupo.
+    auto emit = [&](uint32_t symbol) {
+        if (symbol != rowEnd) {
+            out.append(utf8[symbol]);
+            if (++j < width) {
+                return false;
+            }
+        }
+        cells += j;
+        j = 0;
+        if (++row == rows) {
+            return true;
+        }
+        out.put('\n');
+        return false;
+    };
+
+    bool done = false;
+    while (!done && readers[0].bitsLeft() >= safeBits && readers[1].bitsLeft() >= safeBits &&
+           readers[2].bitsLeft() >= safeBits && readers[3].bitsLeft() >= safeBits) {
+        const uint32_t s0 = codes.decode(readers[0]);
+        const uint32_t s1 = codes.decode(readers[1]);
+        const uint32_t s2 = codes.decode(readers[2]);
+        const uint32_t s3 = codes.decode(readers[3]);
+        // Quedaban códigos en todos los streams: ninguno puede sobrar
+        if (emit(s0) || emit(s1) || emit(s2)) {
+            throw std::runtime_error("Códigos de más en el payload del binario.");
+        }
+        done = emit(s3);
+    }
+    for (uint32_t k = 0; !done; k = (k + 1) % InterleavedSource::kStreams) {
+        if (readers[k].overrun()) {
+            throw std::runtime_error("Archivo binario incompleto al leer payload.");
+        }
+        done = emit(codes.decode(readers[k]));
+    }
+    for (uint32_t k = 0; k < InterleavedSource::kStreams; ++k) {
+        if (readers[k].overrun()) {
+            throw std::runtime_error("Archivo binario incompleto al leer payload.");
+        }
+    }
+    return cells;
+}
+
+// Decodifica las filas de un grupo de streams Huffman intercalados.
+template <class Sink>
+uint64_t decodeInterleavedGroup(Sink& out, const LoadedFrame& frame, const StreamGroup& group, int cols,
+                                bool ragged, bool firstRow) {
+    static_assert(InterleavedSource::kStreams == 4, "un BitReader por stream");
+    const unsigned char* start[InterleavedSource::kStreams];
+    const unsigned char* p = frame.payload.data() + group.offset;
+    for (uint32_t k = 0; k < InterleavedSource::kStreams; ++k) {
+        start[k] = p;
+        p += group.streams[k];
+    }
+    BitReader readers[InterleavedSource::kStreams] = {
+        BitReader(start[0], static_cast<size_t>(group.streams[0])),
+        BitReader(start[1], static_cast<size_t>(group.streams[1])),
+        BitReader(start[2], static_cast<size_t>(group.streams[2])),
+        BitReader(start[3], static_cast<size_t>(group.streams[3])),
+    };
+    if (frame.numTables() == 1 && frame.table(0).runSymbol == kNoSymbol &&
+        !frame.table(0).dict.decodeTable().empty() && group.rows > 0 && (ragged || cols > 0)) {
+        return decodeInterleavedPlain(out, frame.table(0), readers, group.rows, cols, ragged, firstRow);
+    }
+    InterleavedSource source{frame, readers};
+    uint64_t cells = decodeRows(out, frame, source, group.rows, cols, ragged, firstRow);
+    if (source.allOverrun()) {
+        throw std::runtime_error("Archivo binario incompleto al leer payload.");
+    }
+    return cells;
+}
+
+// Decodifica un grupo con streams propios según el payload del frame.
+template <class Sink>
+uint64_t decodeStreamGroup(Sink& out, const LoadedFrame& frame, const StreamGroup& group, int cols, bool ragged,
+                           bool firstRow) {
+    return frame.rans ? decodeRansGroup(out, frame, group, cols, ragged, firstRow)
+                      : decodeInterleavedGroup(out, frame, group, cols, ragged, firstRow);
+}
+
+// Decodifica las filas de un grupo LZ77 desde 'bits': tokens hasta completar
+// los bytes de texto del grupo, que ya trae los '\n' entre filas.
+template <class Sink>
+void decodeLzGroup(Sink& out, const LoadedFrame& frame, BitReader& bits, const LzGroup& group, bool firstRow) {
+    if (!firstRow) {
+        out.put('\n');
+    }
+    const DecodeTable& literals = frame.tables[0].dict.decodeTable();
+    const DecodeTable& distances = frame.distances.decodeTable();
+    if (group.textBytes > 0 && literals.empty()) {
+        throw std::runtime_error("Diccionario vacío o inválido en el binario.");
+    }
+    const LzCode* literalCodes = frame.lzLiterals.data();
+    const LzCode* distanceCodes = frame.lzDistances.data();
+    thread_local std::vector<char> buffer;
+    LzHistory<Sink> history(out, buffer);
+    while (history.written() < group.textBytes) {
+        const LzCode& code = literalCodes[literals.decode(bits)];
+        const uint64_t left = group.textBytes - history.written();
+        if (code.size != 0) {
+            if (code.size > left || bits.overrun()) {
+                throw std::runtime_error("Archivo binario incompleto al leer payload.");
+            }
+            history.literal(code.utf8, code.size);
+            continue;
+        }
+        if (distances.empty()) {
+            throw std::runtime_error("Copia LZ77 sin tabla de distancias en el binario.");
+        }
+        uint64_t length = huffman::formato::kMinLargoLZ + code.base;
+        if (code.extra > 0) {
+            length += bits.readBits(code.extra);
+        }
+        const LzCode& distanceCode = distanceCodes[distances.decode(bits)];
+        uint64_t distance = 1 + distanceCode.base;
+        if (distanceCode.extra > 0) {
+            distance += bits.readBits(distanceCode.extra);
+        }
+        if (bits.overrun()) {
+            throw std::runtime_error("Archivo binario incompleto al leer payload.");
+        }
+        if (length > left || distance > history.written() || distance > LzHistory<Sink>::kWindow) {
+            throw std::runtime_error("Copia LZ77 fuera del texto en el binario.");
+        }
+        history.copy(static_cast<size_t>(distance), length);
+    }
+    history.finish();
+}
+
+// Decodifica el texto de un frame BWT (un solo grupo con todas sus filas):
+// deshace las rachas de ceros y move-to-front hasta tener la última columna
+// y la recorre hacia adelante escribiendo cada carácter.
+template <class Sink>
+void decodeBwtFrame(Sink& out, const LoadedFrame& frame, bool firstRow) {
+    namespace formato = huffman::formato;
+    if (!firstRow) {
+        out.put('\n');
+    }
+    const FrameTable& table = frame.tables[0];
+    const DecodeTable& codes = table.dict.decodeTable();
+    const std::vector<uint32_t>& mtfSymbols = table.dict.symbols();
+    const size_t length = static_cast<size_t>(frame.bwtLength);
+    const uint32_t alphabet = static_cast<uint32_t>(table.utf8.size());
+    if (length == 0) {
+        return;
+    }
+    if (codes.empty() || alphabet == 0) {
+        throw std::runtime_error("Diccionario vacío o inválido en el binario.");
+    }
+
+    // 1. Última columna (sin el centinela), en índices del alfabeto
+    std::vector<uint32_t> last(length);
+    std::vector<uint32_t> order(alphabet);
+    for (uint32_t c = 0; c < alphabet; ++c) {
+        order[c] = c;
+    }
+    BitReader bits(frame.payload.data(), frame.payload.size());
+    size_t done = 0;
+    uint64_t run = 0;
+    uint64_t weight = 1;
+    while (done + run < length) {
+        const uint32_t symbol = mtfSymbols[codes.decode(bits)];
+        if (bits.overrun()) {
+            throw std::runtime_error("Archivo binario incompleto al leer payload.");
+        }
+        if (symbol == formato::kSimboloRunA || symbol == formato::kSimboloRunB) {
+            // Dígitos de base 2 biyectiva, del menos significativo
+            run += symbol == formato::kSimboloRunA ? weight : 2 * weight;
+            weight *= 2;
+            if (run > length - done) {
+                throw std::runtime_error("Racha de ceros fuera del texto en el binario.");
+            }
+            continue;
+        }
+        std::fill(last.begin() + static_cast<std::ptrdiff_t>(done),
+                  last.begin() + static_cast<std::ptrdiff_t>(done + run), order[0]);
+        done += static_cast<size_t>(run);
+        run = 0;
+        weight = 1;
+        const uint32_t position = symbol - 1;
+        if (position >= alphabet || done == length) {
+            throw std::runtime_error("Símbolo move-to-front fuera de rango en el binario.");
+        }
+        const uint32_t c = order[position];
+        std::memmove(order.data() + 1, order.data(), position * sizeof(uint32_t));
+        order[0] = c;
+        last[done++] = c;
+    }
+    std::fill(last.begin() + static_cast<std::ptrdiff_t>(done), last.end(), order[0]);
+
+    // 2. Inversa: next[i] es la fila que empieza un carácter después que la
+    // i. La fila 0 es la del centinela, que en la última columna está en
+    // 'primary'; ahí la columna completa tiene 'alphabet', fuera de rango
+    const size_t primary = frame.bwtPoints[0];
+    last.insert(last.begin() + static_cast<std::ptrdiff_t>(primary), alphabet);
+    std::vector<uint32_t> start(alphabet + 1, 0);
+    for (uint32_t c : last) {
+        if (c < alphabet) {
+            ++start[c + 1];
+        }
+    }
+    start[0] = 1;
+    for (uint32_t c = 0; c < alphabet; ++c) {
+        start[c + 1] += start[c];
+    }
+    std::vector<uint32_t> next(length + 1);
+    next[0] = static_cast<uint32_t>(primary);
+    for (size_t j = 0; j <= length; ++j) {
+        if (j != primary) {
+            next[start[last[j]]++] = static_cast<uint32_t>(j);
+        }
+    }
+
+    // 3. Un tramo del texto por punto, todos a la vez: cada paso es un acceso
+    // a memoria que no depende de los de los otros tramos
+    const size_t points = frame.bwtPoints.size();
+    const size_t step = huffman::formato::pasoPuntosBWT(length, static_cast<uint32_t>(points));
+    if ((length + step - 1) / step != points) {
+        throw std::runtime_error("Transformada BWT inconsistente en el binario.");
+    }
+    std::vector<uint32_t> text(length);
+    uint32_t rows[huffman::formato::kMaxPuntosBWT];
+    std::copy(frame.bwtPoints.begin(), frame.bwtPoints.end(), rows);
+    auto walk = [&](size_t k, size_t pos) {
+        rows[k] = next[rows[k]];
+        const uint32_t c = last[rows[k]];
+        // Solo el centinela lleva a la fila 'primary': el tramo terminó antes
+        if (c == alphabet) {
+            throw std::runtime_error("Transformada BWT inconsistente en el binario.");
+        }
+        text[pos] = c;
+    };
+    const size_t fullPoints = length / step;  // tramos de 'step' posiciones
+    for (size_t j = 0; j < step; ++j) {
+        for (size_t k = 0; k < fullPoints; ++k) {
+            walk(k, k * step + j);
+        }
+    }
+    for (size_t pos = fullPoints * step; pos < length; ++pos) {
+        walk(fullPoints, pos);
+    }
+    const std::string* utf8 = table.utf8.data();
+    for (uint32_t c : text) {
+        out.append(utf8[c]);
+    }
+}
+
+// Lee una tabla canónica (ver huffman/Formato.hpp) y la carga en el diccionario.
+// Devuelve la cantidad de símbolos (0 si la tabla está vacía). Con
+// 'maxCodeLength' > 0 rechaza códigos más largos que lo declarado. Los
+// símbolos van hasta 'maxSymbol' (por defecto, el último codepoint).
+int readCanonicalTable(std::istream& in, Dictionary& dict, int maxCodeLength, uint32_t maxSymbol = 0x10FFFF) {
+    int numSymbols = readVarintInt(in);
+    if (numSymbols == 0) {
+        dict.clear();
+        return 0;
+    }
+
+    int maxLength = in.get();
+    if (maxLength <= 0 || (maxCodeLength > 0 && maxLength > maxCodeLength)) {
+        throw std::runtime_error("Longitud máxima de código inválida en el binario.");
+    }
+    std::vector<uint32_t> lengthCounts(static_cast<size_t>(maxLength) + 1, 0);
+    for (int len = 1; len <= maxLength; ++len) {
+        lengthCounts[static_cast<size_t>(len)] = static_cast<uint32_t>(readVarintInt(in));
+    }
+
+    std::vector<uint32_t> symbols;
+    symbols.reserve(static_cast<size_t>(numSymbols));
+    for (int i = 0; i < numSymbols; ++i) {
+        uint64_t cp = readVarint(in);
+        if (cp > maxSymbol) {
+            throw std::runtime_error("Codepoint fuera de rango en la tabla del binario.");
+        }
+        symbols.push_back(static_cast<uint32_t>(cp));
+    }
+    dict.loadCanonical(symbols, lengthCounts);
+    return numSymbols;
+}
+
+// Tablas compartidas ya cargadas (Decoder::loadSharedTable), por id y hash.
+// Se leen y compilan una vez; cada frame kFrameCompartido apunta a la suya.
+std::mutex sharedTablesMutex;
+std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<const FrameTable>> sharedTables;
+
+// La tabla compartida que nombra un frame.
+std::shared_ptr<const FrameTable> findSharedTable(uint32_t id, uint32_t hash) {
+    std::lock_guard<std::mutex> lock(sharedTablesMutex);
+    auto it = sharedTables.find({id, hash});
+    if (it != sharedTables.end()) {
+        return it->second;
+    }
+    for (const auto& entry : sharedTables) {
+        if (entry.first.first == id) {
+            throw std::runtime_error("La tabla compartida " + std::to_string(id) +
+                                     " cargada no es la que usa el binario (hash distinto).");
+        }
+    }
+    throw std::runtime_error("El binario usa la tabla compartida " + std::to_string(id) + ", que no está cargada.");
+}
+
+// Lee una tabla rANS (ver huffman/Formato.hpp). Una tabla vacía deja 'table' vacía.
+void readRansTable(std::istream& in, RansTable& table) {
+    int numSymbols = readVarintInt(in);
+    if (numSymbols == 0) {
+        table.clear();
+        return;
+    }
+    int scaleBits = in.get();
+    if (scaleBits <= 0 || numSymbols > (1 << std::min<int>(scaleBits, 30))) {
+        throw std::runtime_error("Escala inválida en la tabla rANS del binario.");
+    }
+    std::vector<uint32_t> symbols(static_cast<size_t>(numSymbols));
+    std::vector<uint32_t> freqs(static_cast<size_t>(numSymbols));
+    for (int i = 0; i < numSymbols; ++i) {
+        uint64_t cp = readVarint(in);
+        if (cp > 0x10FFFF) {
+            throw std::runtime_error("Codepoint fuera de rango en la tabla del binario.");
+        }
+        symbols[static_cast<size_t>(i)] = static_cast<uint32_t>(cp);
+        freqs[static_cast<size_t>(i)] = static_cast<uint32_t>(readVarintInt(in));
+    }
+    table.load(symbols, freqs, scaleBits);
+}
+
+// Cabecera versionada: firma "UNCB" + version + flags + dimensiones.
+// En la versión 2 la sigue la única tabla canónica del archivo.
+BinaryHeader readVersionedHeader(std::istream& in, Dictionary& dict) {
+    BinaryHeader header;
+    header.version = in.get();
+    header.flags = in.get();
+    if (header.version != huffman::formato::kVersionCanonica && !hasFrames(header)) {
+        throw std::runtime_error("Versión de formato .bin no soportada.");
+    }
+    const bool stream = header.version == huffman::formato::kVersionFlujo;
+    int knownFlags = huffman::formato::kFlagCanonico | huffman::formato::kFlagLongitudMaxima;
+    if (hasFrames(header)) {
+        knownFlags |= huffman::formato::kFlagIrregular | huffman::formato::kFlagContexto |
+                      huffman::formato::kFlagRANS | huffman::formato::kFlagIntercalado;
+    }
+    if (header.version == huffman::formato::kVersionBloques) {
+        knownFlags |= huffman::formato::kFlagIndice | huffman::formato::kFlagRachasFondo;
+    }
+    const int bothPayloads = huffman::formato::kFlagRANS | huffman::formato::kFlagIntercalado;
+    if ((header.flags & huffman::formato::kFlagCanonico) == 0 || (header.flags & ~knownFlags) != 0 ||
+        (header.flags & bothPayloads) == bothPayloads ||
+        (stream && (header.flags & huffman::formato::kFlagIrregular) == 0)) {
+        throw std::runtime_error("Flags desconocidos en la cabecera del binario.");
+    }
+
+    // Un flujo no conoce sus dimensiones: las filas llegan en el cierre
+    if (!stream) {
+        header.rows = readVarintInt(in);
+        header.cols = readVarintInt(in);
+    }
+    if (header.flags & huffman::formato::kFlagLongitudMaxima) {
+        header.maxCodeLength = in.get();
+        if (header.maxCodeLength <= 0 || header.maxCodeLength > DecodeTable::kMaxCodeLength) {
+            throw std::runtime_error("Longitud máxima de código inválida en el binario.");
+        }
+    }
+    if (header.flags & huffman::formato::kFlagRachasFondo) {
+        uint64_t background = readVarint(in);
+        if (background > 0x10FFFF) {
+            throw std::runtime_error("Codepoint fuera de rango en la cabecera del binario.");
+        }
+        header.background = static_cast<uint32_t>(background);
+    }
+    if (header.flags & huffman::formato::kFlagIndice) {
+        header.indexOffset = readU64(in);
+    }
+    if (header.version == huffman::formato::kVersionCanonica) {
+        header.dictSize = readCanonicalTable(in, dict, header.maxCodeLength);
+        if (header.dictSize <= 0) {
+            throw std::runtime_error("Diccionario vacío o inválido en el binario.");
+        }
+    }
+    return header;
 }
 
 // Extrae filas/columnas y rellena el Dictionary con los pares almacenados.
-BinaryHeader readHeaderAndDictionary(std::ifstream& in, Dictionary& dict) {
+// Distingue los binarios con firma de los originales (que no la tienen).
+BinaryHeader readHeaderAndDictionary(std::istream& in, Dictionary& dict) {
+    char magic[sizeof(huffman::formato::kFirma)] = {};
+    if (in.read(magic, sizeof(magic)) &&
+        std::memcmp(magic, huffman::formato::kFirma, sizeof(magic)) == 0) {
+        return readVersionedHeader(in, dict);
+    }
+    in.clear();
+    in.seekg(0);
+
     BinaryHeader header;
     header.rows = readInt(in);
     header.cols = readInt(in);
@@ -149,48 +1213,698 @@ BinaryHeader readHeaderAndDictionary(std::ifstream& in, Dictionary& dict) {
         if (code.empty()) {
             throw std::runtime_error("Código vacío encontrado en el diccionario del binario.");
         }
-        dict.insert(code, symbol);
+        dict.insert(code, tokenToCodepoint(symbol));
     }
+    dict.buildDecodeTable();
     return header;
 }
 
+// Lee un byte que indica una de las 'count' tablas del frame.
+uint8_t readTableNumber(std::istream& in, size_t count) {
+    int value = in.get();
+    if (value < 0 || static_cast<size_t>(value) >= count) {
+        throw std::runtime_error("Número de tabla inválido en el binario.");
+    }
+    return static_cast<uint8_t>(value);
+}
+
+// Lee lo que sigue a las filas de un frame (tablas, tabla de rachas,
+// contextos, grupos de streams y payload) y prepara lo que hace falta para
+// decodificar cualquier tramo suyo. Con 'shared' (kFrameCompartido) en lugar
+// de las tablas viene la referencia a una tabla compartida.
+void readFrameBody(std::istream& in, const BinaryHeader& header, uint64_t rows, LoadedFrame& frame,
+                   bool shared) {
+    const bool rans = (header.flags & huffman::formato::kFlagRANS) != 0;
+    const bool interleaved = (header.flags & huffman::formato::kFlagIntercalado) != 0;
+    frame.rans = rans;
+    auto symbolsOf = [rans](const FrameTable& t) -> const std::vector<uint32_t>& {
+        return rans ? t.rans.symbols() : t.dict.symbols();
+    };
+    size_t numTables = 1;
+    if (header.flags & huffman::formato::kFlagContexto) {
+        int value = in.get();
+        if (value <= 0 || static_cast<uint32_t>(value) > huffman::formato::kMaxTablasContexto) {
+            throw std::runtime_error("Cantidad de tablas inválida en el binario.");
+        }
+        numTables = static_cast<size_t>(value);
+    }
+    if (shared) {
+        const int unsupported = huffman::formato::kFlagRachasFondo | huffman::formato::kFlagContexto |
+                                huffman::formato::kFlagRANS;
+        if (header.flags & unsupported) {
+            throw std::runtime_error("Frame con flags incompatibles en el binario.");
+        }
+        const uint64_t id = readVarint(in);
+        const uint32_t hash = readU32(in);
+        if (id > UINT32_MAX) {
+            throw std::runtime_error("Tabla compartida inválida en el binario.");
+        }
+        const auto table = findSharedTable(static_cast<uint32_t>(id), hash);
+        if (header.maxCodeLength > 0 && table->dict.decodeTable().maxLength() > header.maxCodeLength) {
+            throw std::runtime_error("Longitud máxima de código inválida en el binario.");
+        }
+        frame.shared = table;
+    } else {
+        frame.tables.resize(numTables);
+        for (auto& t : frame.tables) {
+            if (rans) {
+                readRansTable(in, t.rans);
+            } else {
+                readCanonicalTable(in, t.dict, header.maxCodeLength);
+            }
+        }
+    }
+    if (header.flags & huffman::formato::kFlagRachasFondo) {
+        if (rans) {
+            readRansTable(in, frame.ransRuns);
+        } else {
+            readCanonicalTable(in, frame.runs, header.maxCodeLength);
+        }
+        for (uint32_t runClass : rans ? frame.ransRuns.symbols() : frame.runs.symbols()) {
+            if (runClass >= huffman::formato::kClasesRacha) {
+                throw std::runtime_error("Clase de racha fuera de rango en la tabla del binario.");
+            }
+        }
+    }
+
+    // Tabla siguiente de cada símbolo de la unión, en orden de codepoint
+    std::vector<uint32_t> all;
+    std::vector<uint8_t> nextOf;
+    if (numTables > 1) {
+        frame.firstTable = readTableNumber(in, numTables);
+        for (const auto& t : frame.tables) {
+            all.insert(all.end(), symbolsOf(t).begin(), symbolsOf(t).end());
+        }
+        std::sort(all.begin(), all.end());
+        all.erase(std::unique(all.begin(), all.end()), all.end());
+        nextOf.resize(all.size());
+        for (auto& next : nextOf) {
+            next = readTableNumber(in, numTables);
+        }
+    }
+
+    const bool ragged = (header.flags & huffman::formato::kFlagIrregular) != 0;
+    bool hasRowEnd = frame.shared && frame.shared->rowEnd != kNoSymbol;
+    for (auto& t : frame.tables) {
+        const auto& symbols = symbolsOf(t);
+        t.utf8 = symbolsToUtf8(symbols);
+        t.next.assign(symbols.size(), 0);
+        if (numTables > 1) {
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                auto it = std::lower_bound(all.begin(), all.end(), symbols[i]);
+                t.next[i] = nextOf[static_cast<size_t>(it - all.begin())];
+            }
+        }
+        if (ragged) {
+            t.rowEnd = findSymbol(symbols, '\n');
+            hasRowEnd = hasRowEnd || t.rowEnd != kNoSymbol;
+        }
+        if (header.flags & huffman::formato::kFlagRachasFondo) {
+            t.runSymbol = findSymbol(symbols, header.background);
+        }
+    }
+    if (ragged && rows > 0 && !hasRowEnd) {
+        throw std::runtime_error("Falta el símbolo de fin de fila en la tabla del binario.");
+    }
+
+    // Con rANS o streams intercalados, filas y bytes de los streams de cada
+    // grupo, que deben cubrir el frame y el payload exactos
+    uint64_t groupRows = 0;
+    uint64_t groupBytes = 0;
+    auto addBytes = [&groupBytes](uint64_t bytes) {
+        if (bytes > UINT64_MAX - groupBytes) {
+            throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+        }
+        groupBytes += bytes;
+        return bytes;
+    };
+    if (rans || interleaved) {
+        uint64_t numGroups = readVarint(in);
+        if (numGroups > rows) {
+            throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+        }
+        frame.groups.resize(static_cast<size_t>(numGroups));
+        for (auto& group : frame.groups) {
+            group.rows = readVarint(in);
+            if (group.rows == 0 || group.rows > rows - groupRows) {
+                throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+            }
+            group.offset = groupBytes;
+            if (rans) {
+                group.size = addBytes(readVarint(in));
+            } else {
+                for (auto& stream : group.streams) {
+                    group.size += addBytes(stream = readVarint(in));
+                }
+            }
+            groupRows += group.rows;
+        }
+    }
+    frame.payload = readBytes(in, readVarint(in));
+    if (!frame.groups.empty() && (groupRows != rows || groupBytes != frame.payload.size())) {
+        throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+    }
+}
+
+// Los frames LZ77 y BWT no admiten rachas, contextos, rANS ni streams intercalados.
+void checkTransformFlags(const BinaryHeader& header) {
+    const int unsupported = huffman::formato::kFlagRachasFondo | huffman::formato::kFlagContexto |
+                            huffman::formato::kFlagRANS | huffman::formato::kFlagIntercalado;
+    if (header.flags & unsupported) {
+        throw std::runtime_error("Frame con flags incompatibles en el binario.");
+    }
+}
+
+// Lee lo que sigue a las filas de un frame kFrameLZ (las dos tablas, los
+// grupos y el payload) y traduce cada código de las tablas a su literal o su
+// clase, una sola vez por frame.
+void readLzFrameBody(std::istream& in, const BinaryHeader& header, uint64_t rows, LoadedFrame& frame) {
+    namespace formato = huffman::formato;
+    checkTransformFlags(header);
+    frame.lz = true;
+    frame.tables.resize(1);
+    Dictionary& literals = frame.tables[0].dict;
+    readCanonicalTable(in, literals, header.maxCodeLength, formato::kSimboloLargoLZ + formato::kClasesLargoLZ - 1);
+    readCanonicalTable(in, frame.distances, header.maxCodeLength, formato::kClasesDistanciaLZ - 1);
+    auto classCode = [](uint32_t lzClass) {
+        LzCode code;
+        code.base = formato::baseLZ(lzClass);
+        code.extra = static_cast<uint8_t>(formato::bitsExtraLZ(lzClass));
+        return code;
+    };
+    for (uint32_t symbol : literals.symbols()) {
+        if (symbol >= formato::kSimboloLargoLZ) {
+            frame.lzLiterals.push_back(classCode(symbol - formato::kSimboloLargoLZ));
+            continue;
+        }
+        if (symbol > 0x10FFFF) {
+            throw std::runtime_error("Codepoint fuera de rango en la tabla del binario.");
+        }
+        std::string bytes;
+        appendUtf8(bytes, symbol);
+        LzCode code;
+        code.size = static_cast<uint8_t>(bytes.size());
+        std::memcpy(code.utf8, bytes.data(), bytes.size());
+        frame.lzLiterals.push_back(code);
+    }
+    for (uint32_t symbol : frame.distances.symbols()) {
+        frame.lzDistances.push_back(classCode(symbol));
+    }
+
+    uint64_t numGroups = readVarint(in);
+    if (numGroups > rows) {
+        throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+    }
+    uint64_t groupRows = 0;
+    frame.lzGroups.resize(static_cast<size_t>(numGroups));
+    for (auto& group : frame.lzGroups) {
+        group.rows = readVarint(in);
+        if (group.rows == 0 || group.rows > rows - groupRows) {
+            throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+        }
+        group.textBytes = readVarint(in);
+        groupRows += group.rows;
+    }
+    bool emptyRows = header.cols == 0 && (header.flags & formato::kFlagIrregular) == 0;
+    if (groupRows != rows && !emptyRows) {
+        throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+    }
+    frame.payload = readBytes(in, readVarint(in));
+}
+
+// Lee lo que sigue a las filas de un frame kFrameBWT (alfabeto, tabla MTF,
+// largo, fila primaria y payload).
+void readBwtFrameBody(std::istream& in, const BinaryHeader& header, uint64_t rows, LoadedFrame& frame) {
+    checkTransformFlags(header);
+    frame.bwt = true;
+    frame.tables.resize(1);
+    FrameTable& table = frame.tables[0];
+    uint64_t alphabet = readVarint(in);
+    if (alphabet > 0x110000) {
+        throw std::runtime_error("Alfabeto inválido en el binario.");
+    }
+    uint64_t cp = 0;
+    for (uint64_t k = 0; k < alphabet; ++k) {
+        uint64_t delta = readVarint(in);
+        if ((k > 0 && delta == 0) || delta > 0x10FFFF - cp) {
+            throw std::runtime_error("Alfabeto inválido en el binario.");
+        }
+        cp += delta;
+        table.utf8.emplace_back();
+        appendUtf8(table.utf8.back(), static_cast<uint32_t>(cp));
+    }
+    readCanonicalTable(in, table.dict, header.maxCodeLength, static_cast<uint32_t>(alphabet));
+    // Cada fila aporta a lo sumo 'cols' caracteres y su '\n' (en un flujo no
+    // se conoce el ancho)
+    frame.bwtLength = readVarint(in);
+    const uint64_t maxLength = header.version == huffman::formato::kVersionFlujo
+        ? INT32_MAX : std::min<uint64_t>(rows * (static_cast<uint64_t>(header.cols) + 1), INT32_MAX);
+    uint64_t numPoints = readVarint(in);
+    if (frame.bwtLength > maxLength || numPoints > huffman::formato::kMaxPuntosBWT ||
+        (numPoints == 0) != (frame.bwtLength == 0)) {
+        throw std::runtime_error("Transformada BWT inconsistente en el binario.");
+    }
+    for (uint64_t k = 0; k < numPoints; ++k) {
+        uint64_t row = readVarint(in);
+        if (row > frame.bwtLength) {
+            throw std::runtime_error("Transformada BWT inconsistente en el binario.");
+        }
+        frame.bwtPoints.push_back(static_cast<uint32_t>(row));
+    }
+    frame.payload = readBytes(in, readVarint(in));
+}
+
+// Tipos de frame con filas (todos menos kFrameFin).
+bool isFrameType(int type) {
+    return type == huffman::formato::kFrameBloque || type == huffman::formato::kFrameLZ ||
+           type == huffman::formato::kFrameBWT || type == huffman::formato::kFrameCompartido;
+}
+
+// Lee el cuerpo de un frame de tipo 'type' (ya leídas sus filas).
+void readFrameBody(std::istream& in, const BinaryHeader& header, int type, uint64_t rows, LoadedFrame& frame) {
+    if (type == huffman::formato::kFrameLZ) {
+        readLzFrameBody(in, header, rows, frame);
+    } else if (type == huffman::formato::kFrameBWT) {
+        readBwtFrameBody(in, header, rows, frame);
+    } else {
+        readFrameBody(in, header, rows, frame, type == huffman::formato::kFrameCompartido);
+    }
+}
+
+// Versión 3 y de flujo: recorre los frames, cada uno con su propia tabla, y
+// concatena sus filas. Cada frame queda en 'out' antes de leer el siguiente.
+template <class Sink>
+void decodeFrames(std::istream& file, const BinaryHeader& header, Dictionary& dict, Sink& out) {
+    const bool ragged = (header.flags & huffman::formato::kFlagIrregular) != 0;
+    long long rowsDone = 0;
+    std::shared_ptr<const FrameTable> lastShared;  // la tabla del último frame, si era compartida
+    while (true) {
+        int type = file.get();
+        if (type == EOF) {
+            throw std::runtime_error("Archivo .bin incompleto: falta el frame final.");
+        }
+        if (type == huffman::formato::kFrameFin) {
+            break;
+        }
+        if (!isFrameType(type)) {
+            throw std::runtime_error("Tipo de frame desconocido en el binario.");
+        }
+
+        int rows = readVarintInt(file);
+        LoadedFrame frame;
+        readFrameBody(file, header, type, static_cast<uint64_t>(rows), frame);
+        if (frame.bwt) {
+            if (rows > 0 && (ragged || header.cols != 0)) {
+                decodeBwtFrame(out, frame, rowsDone == 0);
+            }
+        } else if (frame.lz) {
+            BitReader bitReader(frame.payload.data(), frame.payload.size());
+            uint64_t groupRows = 0;
+            for (const auto& group : frame.lzGroups) {
+                decodeLzGroup(out, frame, bitReader, group, rowsDone + groupRows == 0);
+                groupRows += group.rows;
+            }
+        } else if (header.flags & (huffman::formato::kFlagRANS | huffman::formato::kFlagIntercalado)) {
+            uint64_t groupRows = 0;
+            for (const auto& group : frame.groups) {
+                decodeStreamGroup(out, frame, group, header.cols, ragged, rowsDone + groupRows == 0);
+                groupRows += group.rows;
+            }
+            if (groupRows != static_cast<uint64_t>(rows) && (ragged || header.cols != 0)) {
+                throw std::runtime_error("Grupos de streams inconsistentes en el binario.");
+            }
+        } else {
+            BitReader bitReader(frame.payload.data(), frame.payload.size());
+            HuffmanSource source{frame, bitReader};
+            decodeRows(out, frame, source, static_cast<uint64_t>(rows), header.cols, ragged, rowsDone == 0);
+        }
+        rowsDone += rows;
+        if (frame.shared) {
+            lastShared = frame.shared;
+        } else {
+            dict = std::move(frame.tables[0].dict);
+            lastShared.reset();
+        }
+        out.endFrame();
+    }
+    if (lastShared) {
+        dict = lastShared->dict;
+    }
+
+    if (header.version == huffman::formato::kVersionFlujo) {
+        const uint64_t totalRows = readVarint(file);
+        const int finalNewline = file.get();
+        if (totalRows != static_cast<uint64_t>(rowsDone) || (finalNewline != 0 && finalNewline != 1)) {
+            throw std::runtime_error("Cierre del flujo inconsistente con sus frames.");
+        }
+        if (finalNewline == 1) {
+            out.put('\n');
+        }
+        return;
+    }
+    if (rowsDone != header.rows) {
+        throw std::runtime_error("Cantidad de filas inconsistente entre la cabecera y los frames.");
+    }
+}
+
+// Versión 1 y 2: una sola tabla (ya cargada en 'dict') y el payload hasta el final.
+template <class Sink>
+void decodeSingleTable(std::istream& file, const BinaryHeader& header, const Dictionary& dict, Sink& out) {
+    long long totalCells = static_cast<long long>(header.rows) * static_cast<long long>(header.cols);
+    if (totalCells < 0) {
+        throw std::runtime_error("Dimensiones inválidas en el binario.");
+    }
+    if (header.rows == 0 || header.cols == 0) {
+        return;
+    }
+    LoadedFrame frame;
+    frame.tables.resize(1);
+    frame.tables[0].dict = dict;
+    frame.tables[0].utf8 = symbolsToUtf8(dict.symbols());
+    frame.payload = readPayload(file);
+    BitReader bitReader(frame.payload.data(), frame.payload.size());
+    HuffmanSource source{frame, bitReader};
+    decodeRows(out, frame, source, static_cast<uint64_t>(header.rows), header.cols, false, true);
+}
+
+// Lee el índice de frames y grupos, validando que cubra todas las filas.
+std::vector<IndexFrame> readIndex(std::istream& in, const BinaryHeader& header) {
+    in.seekg(static_cast<std::streamoff>(header.indexOffset));
+    if (!in) {
+        throw std::runtime_error("Posición de índice inválida en el binario.");
+    }
+    uint64_t numFrames = readVarint(in);
+    if (numFrames > static_cast<uint64_t>(header.rows)) {
+        throw std::runtime_error("Índice inconsistente en el binario.");
+    }
+    std::vector<IndexFrame> frames(static_cast<size_t>(numFrames));
+    uint64_t totalRows = 0;
+    for (auto& frame : frames) {
+        frame.offset = readVarint(in);
+        frame.rows = readVarint(in);
+        uint64_t numGroups = readVarint(in);
+        if (numGroups > frame.rows) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+        frame.groups.resize(static_cast<size_t>(numGroups));
+        for (size_t g = 0; g < frame.groups.size(); ++g) {
+            IndexGroup& group = frame.groups[g];
+            group.firstRow = readVarint(in);
+            group.firstBit = readVarint(in);
+            group.symbols = readVarint(in);
+            group.outBytes = readVarint(in);
+            uint64_t minFirstRow = g == 0 ? 0 : frame.groups[g - 1].firstRow + 1;
+            if ((g == 0 && group.firstRow != 0) || group.firstRow < minFirstRow || group.firstRow >= frame.rows ||
+                group.outBytes > group.symbols * 4) {
+                throw std::runtime_error("Índice inconsistente en el binario.");
+            }
+        }
+        bool emptyRows = header.cols == 0 && (header.flags & huffman::formato::kFlagIrregular) == 0;
+        if (frame.groups.empty() && frame.rows > 0 && !emptyRows) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+        totalRows += frame.rows;
+    }
+    if (totalRows != static_cast<uint64_t>(header.rows)) {
+        throw std::runtime_error("Cantidad de filas inconsistente entre la cabecera y el índice.");
+    }
+    return frames;
+}
+
+// Lee el frame que empieza en 'offset' (tablas + payload) sin decodificarlo.
+std::shared_ptr<LoadedFrame> loadFrame(std::istream& in, const IndexFrame& entry, const BinaryHeader& header) {
+    in.seekg(static_cast<std::streamoff>(entry.offset));
+    int type = in.get();
+    if (!isFrameType(type)) {
+        throw std::runtime_error("El índice no apunta a un frame válido.");
+    }
+    if (readVarint(in) != entry.rows) {
+        throw std::runtime_error("Cantidad de filas inconsistente entre el índice y los frames.");
+    }
+    auto frame = std::make_shared<LoadedFrame>();
+    readFrameBody(in, header, type, entry.rows, *frame);
+    return frame;
+}
+
+// Decodifica un grupo de filas directamente en su tramo [dst, dst + size) de la salida.
+// Con 'ragged' cada fila termina en el fin de fila en vez de tener 'cols' celdas.
+// Con rANS o streams intercalados 'streamGroup' son los streams del grupo
+// según el frame, y en un frame LZ77 'lzGroup' es el grupo; si no, nullptr.
+// Un frame BWT es un solo grupo con todas sus filas.
+void decodeGroup(const LoadedFrame& frame, const IndexGroup& group, const StreamGroup* streamGroup,
+                 const LzGroup* lzGroup, uint64_t rows, int cols, bool ragged, bool firstRow, char* dst,
+                 size_t size) {
+    if (!ragged && group.symbols != rows * static_cast<uint64_t>(cols)) {
+        throw std::runtime_error("Índice inconsistente en el binario.");
+    }
+    SpanSink sink(dst, dst + size);
+    uint64_t cells = 0;
+    // Con LZ77 y BWT las celdas no se cuentan: alcanza con que el texto llene
+    // el tramo
+    const bool countCells = lzGroup == nullptr && !frame.bwt;
+    if (frame.bwt) {
+        decodeBwtFrame(sink, frame, firstRow);
+    } else if (lzGroup != nullptr) {
+        const size_t startByte = static_cast<size_t>(group.firstBit >> 3);
+        if (lzGroup->rows != rows || startByte > frame.payload.size()) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+        BitReader bitReader(frame.payload.data() + startByte, frame.payload.size() - startByte);
+        bitReader.refill();
+        bitReader.consume(static_cast<int>(group.firstBit & 7));
+        decodeLzGroup(sink, frame, bitReader, *lzGroup, firstRow);
+    } else if (streamGroup != nullptr) {
+        if (streamGroup->offset * 8 != group.firstBit || streamGroup->rows != rows) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+        cells = decodeStreamGroup(sink, frame, *streamGroup, cols, ragged, firstRow);
+    } else {
+        const size_t startByte = static_cast<size_t>(group.firstBit >> 3);
+        if (startByte > frame.payload.size()) {
+            throw std::runtime_error("Índice inconsistente en el binario.");
+        }
+        BitReader bitReader(frame.payload.data() + startByte, frame.payload.size() - startByte);
+        bitReader.refill();
+        bitReader.consume(static_cast<int>(group.firstBit & 7));
+        HuffmanSource source{frame, bitReader};
+        cells = decodeRows(sink, frame, source, rows, cols, ragged, firstRow);
+    }
+    if (ragged && countCells && cells + rows != group.symbols) {
+        throw std::runtime_error("Índice inconsistente en el binario.");
+    }
+    if (!sink.full()) {
+        throw std::runtime_error("Índice inconsistente en el binario.");
+    }
+}
+
+// Bytes que ocupa la salida completa según el índice: los de cada grupo más
+// un '\n' entre filas.
+uint64_t indexedOutputSize(const std::vector<IndexFrame>& index, const BinaryHeader& header) {
+    const bool ragged = (header.flags & huffman::formato::kFlagIrregular) != 0;
+    if ((header.cols == 0 && !ragged) || header.rows == 0) {
+        return 0;
+    }
+    uint64_t total = static_cast<uint64_t>(header.rows) - 1; // saltos de línea
+    for (const auto& frame : index) {
+        for (const auto& group : frame.groups) {
+            total += group.outBytes;
+        }
+    }
+    return total;
+}
+
+// Versión 3 con índice: cada grupo de filas se decodifica en un hilo y se
+// escribe en su posición final de [out, out + size), conocida de antemano por
+// los tamaños del índice.
+void decodeFramesParallel(std::istream& file, const BinaryHeader& header, const std::vector<IndexFrame>& index,
+                          Dictionary& dict, size_t threads, char* out, size_t size, MappedOutput* output = nullptr) {
+    if (size == 0) {
+        return;
+    }
+    const bool ragged = (header.flags & huffman::formato::kFlagIrregular) != 0;
+    const bool streams = (header.flags & (huffman::formato::kFlagRANS | huffman::formato::kFlagIntercalado)) != 0;
+
+    std::shared_ptr<LoadedFrame> last;
+    {
+        // Como en la compresión, una ventana de ~2 tareas por hilo acota los
+        // frames cargados a la vez: antes de leer el siguiente se espera al
+        // grupo más antiguo, y cada tarea suelta su frame al terminar. Lo
+        // anterior a ese grupo ya está escrito y se libera de la salida.
+        huffman::PoolHilos pool(threads);
+        const size_t maxInFlight = 2 * huffman::PoolHilos::resolverHilos(threads);
+        std::deque<std::pair<std::future<void>, size_t>> pending;
+        auto finishOldest = [&]() {
+            pending.front().first.get();
+            if (output != nullptr) {
+                output->discard(pending.front().second);
+            }
+            pending.pop_front();
+        };
+        uint64_t rowsDone = 0;
+        size_t pos = 0;
+        for (const auto& entry : index) {
+            while (pending.size() >= maxInFlight) {
+                finishOldest();
+            }
+            std::shared_ptr<LoadedFrame> frame = loadFrame(file, entry, header);
+            if ((streams && !frame->lz && frame->groups.size() != entry.groups.size()) ||
+                (frame->lz && frame->lzGroups.size() != entry.groups.size()) ||
+                (frame->bwt && entry.groups.size() > 1)) {
+                throw std::runtime_error("Índice inconsistente en el binario.");
+            }
+            for (size_t g = 0; g < entry.groups.size(); ++g) {
+                const IndexGroup& group = entry.groups[g];
+                uint64_t endRow = g + 1 < entry.groups.size() ? entry.groups[g + 1].firstRow : entry.rows;
+                uint64_t rows = endRow - group.firstRow;
+                bool firstRow = rowsDone + group.firstRow == 0;
+                size_t groupSize = static_cast<size_t>(group.outBytes + rows - (firstRow ? 1 : 0));
+                if (groupSize > size - pos) {
+                    throw std::runtime_error("Índice inconsistente en el binario.");
+                }
+                char* dst = out + pos;
+                const StreamGroup* streamGroup = streams && !frame->lz ? &frame->groups[g] : nullptr;
+                const LzGroup* lzGroup = frame->lz ? &frame->lzGroups[g] : nullptr;
+                pos += groupSize;
+                pending.emplace_back(pool.enviar([frame, &group, streamGroup, lzGroup, rows, cols = header.cols,
+                                                  ragged, firstRow, dst, groupSize]() mutable {
+                    decodeGroup(*frame, group, streamGroup, lzGroup, rows, cols, ragged, firstRow, dst, groupSize);
+                    frame.reset();
+                }), pos);
+            }
+            rowsDone += entry.rows;
+            last = frame;
+        }
+        while (!pending.empty()) {
+            finishOldest();
+        }
+    }
+    if (last) {
+        dict = last->table(0).dict;
+    }
+}
+
+// Decide si vale la pena la decodificación en paralelo (hace falta el índice).
+bool useParallel(const BinaryHeader& header, size_t threads) {
+    return header.version == huffman::formato::kVersionBloques && header.indexOffset != 0 &&
+           huffman::PoolHilos::resolverHilos(threads) > 1;
+}
+
 } // namespace
 
 // Punto de entrada público: abre el .bin, carga el diccionario y decodifica el payload.
-std::string Decoder::decodeFile(const std::string& path, Dictionary& dict) {
+std::string Decoder::decodeFile(const std::string& path, Dictionary& dict, size_t threads) {
     std::ifstream file(path, std::ios::binary);
     if (!file.is_open())
         throw std::runtime_error("No se pudo abrir el archivo binario.");
 
     BinaryHeader header = readHeaderAndDictionary(file, dict);
-    long long totalCells = static_cast<long long>(header.rows) * static_cast<long long>(header.cols);
-    if (totalCells < 0) {
-        throw std::runtime_error("Dimensiones inválidas en el binario.");
+    std::string out;
+    if (useParallel(header, threads)) {
+        std::vector<IndexFrame> index = readIndex(file, header);
+        out.resize(static_cast<size_t>(indexedOutputSize(index, header)));
+        decodeFramesParallel(file, header, index, dict, threads, &out[0], out.size());
+        return out;
     }
 
-    BitReader bitReader(file);
-    std::vector<std::string> tokens;
-    tokens.reserve(static_cast<size_t>(totalCells));
-    std::string current_code;
-    current_code.reserve(32);
+    StringSink sink(out);
+    if (hasFrames(header)) {
+        decodeFrames(file, header, dict, sink);
+    } else {
+        decodeSingleTable(file, header, dict, sink);
+    }
+    return out;
+}
 
-    while (static_cast<long long>(tokens.size()) < totalCells) {
-        int bit = bitReader.readBit();
-        if (bit == -1) {
-            throw std::runtime_error("Archivo binario incompleto al leer payload.");
-        }
-        current_code.push_back(bit ? '1' : '0');
+// Igual que decodeFile, pero el texto va directo al archivo de salida.
+void Decoder::decodeToFile(const std::string& path, const std::string& outputPath, Dictionary& dict,
+                           size_t threads) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("No se pudo abrir el archivo binario.");
 
-        std::string decoded;
-        if (dict.tryGetSymbol(current_code, decoded)) {
-            tokens.push_back(decoded);
-            current_code.clear();
-        } else if (!dict.isValidPrefix(current_code)) {
-            throw std::runtime_error("Código Huffman inválido en el payload del binario.");
-        }
+    BinaryHeader header = readHeaderAndDictionary(file, dict);
+    if (useParallel(header, threads)) {
+        std::vector<IndexFrame> index = readIndex(file, header);
+        size_t size = static_cast<size_t>(indexedOutputSize(index, header));
+        MappedOutput output(outputPath, size);
+        decodeFramesParallel(file, header, index, dict, threads, output.data(), size, &output);
+        output.finish();
+        return;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        throw std::runtime_error("No se pudo crear archivo de salida.");
+    FileSink sink(out);
+    if (hasFrames(header)) {
+        decodeFrames(file, header, dict, sink);
+    } else {
+        decodeSingleTable(file, header, dict, sink);
+    }
+    sink.flush();
+    out.close();
+    if (!out)
+        throw std::runtime_error("Error escribiendo el archivo de salida.");
+}
+
+// Como decodeToFile, pero desde un stream que solo se lee hacia adelante.
+void Decoder::decodeStream(std::istream& in, std::ostream& out, Dictionary& dict) {
+    // Los binarios sin firma se reconocen volviendo al principio, y los de
+    // una sola tabla leen el payload hasta el final: ninguno sirve aquí
+    char magic[sizeof(huffman::formato::kFirma)] = {};
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, huffman::formato::kFirma, sizeof(magic)) != 0) {
+        throw std::runtime_error("La entrada no es un binario con cabecera versionada.");
+    }
+    BinaryHeader header = readVersionedHeader(in, dict);
+    if (!hasFrames(header)) {
+        throw std::runtime_error("Solo los binarios por frames se pueden leer desde un stream.");
+    }
+    FileSink sink(out, /*eachFrame=*/true);
+    decodeFrames(in, header, dict, sink);
+    sink.flush();
+    out.flush();
+    if (!out)
+        throw std::runtime_error("Error escribiendo la salida.");
+}
+
+// Carga un archivo de tablas compartidas y lo deja listo para todos los frames que lo nombren.
+void Decoder::loadSharedTable(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        throw std::runtime_error("No se pudo abrir el archivo de tablas: " + path);
+
+    char magic[sizeof(huffman::formato::kFirmaTablas)] = {};
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, huffman::formato::kFirmaTablas, sizeof(magic)) != 0) {
+        throw std::runtime_error("El archivo no es un archivo de tablas: " + path);
+    }
+    if (in.get() != huffman::formato::kVersionTablas) {
+        throw std::runtime_error("Versión de archivo de tablas no soportada: " + path);
+    }
+    const uint64_t id = readVarint(in);
+    const uint32_t hash = readU32(in);
+    if (id > UINT32_MAX) {
+        throw std::runtime_error("Id de tabla inválido en " + path);
+    }
+    const std::streampos tableStart = in.tellg();
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (huffman::formato::hashFNV1a(bytes.data(), bytes.size()) != hash) {
+        throw std::runtime_error("El hash no coincide con la tabla en " + path);
+    }
+    in.clear();
+    in.seekg(tableStart);
+    auto table = std::make_shared<FrameTable>();
+    if (readCanonicalTable(in, table->dict, DecodeTable::kMaxCodeLength) == 0) {
+        throw std::runtime_error("Tabla vacía en " + path);
     }
+    // Lo que readFrameBody completa por frame se deja hecho acá: una sola
+    // tabla, sin rachas, y el fin de fila solo se mira con filas irregulares
+    table->utf8 = symbolsToUtf8(table->dict.symbols());
+    table->next.assign(table->dict.symbols().size(), 0);
+    table->rowEnd = findSymbol(table->dict.symbols(), '\n');
 
-    return formatMatrix(tokens, header.rows, header.cols);
+    std::lock_guard<std::mutex> lock(sharedTablesMutex);
+    sharedTables[{static_cast<uint32_t>(id), hash}] = std::move(table);
 }
 
 void Decoder::writeText(const std::string& path, const std::string& text) {
@@ -7,7 +7,7 @@ Dictionary::Dictionary() = default;
 Dictionary::~Dictionary() = default;
 
 // Inserta un par código->símbolo validando previamente que el código sea binario.
-void Dictionary::insert(const std::string& code, const std::string& symbol) {
+void Dictionary::insert(const std::string& code, uint32_t symbol) {
     if (code.empty()) {
         throw std::invalid_argument("Código Huffman vacío.");
     }
@@ -22,31 +22,65 @@ void Dictionary::insert(const std::string& code, const std::string& symbol) {
 
     // Guardamos/actualizamos el mapeo exacto.
     codes_[code] = symbol;
+}
 
-    // Para decodificar incrementalmente necesitamos saber qué prefijos son válidos.
-    // Insertamos todos los prefijos propios de este código en el set.
-    for (size_t i = 1; i < code.size(); ++i) {
-        prefixes_.insert(code.substr(0, i));
-    }
+// Restablece el diccionario a un estado vacío (útil antes de cargar un binario).
+void Dictionary::clear() {
+    codes_.clear();
+    symbols_.clear();
+    table_ = DecodeTable();
 }
 
-// Busca el símbolo asociado; retorna false si el código aún no es completo.
-bool Dictionary::tryGetSymbol(const std::string& code, std::string& symbol) const {
-    auto it = codes_.find(code);
-    if (it == codes_.end()) {
-        return false;
+// Convierte cada código '0'/'1' a entero y arma la tabla de decodificación.
+// Los índices de símbolo siguen el orden de recorrido de codes_.
+void Dictionary::buildDecodeTable() {
+    std::vector<CodeEntry> entries;
+    entries.reserve(codes_.size());
+    symbols_.clear();
+    symbols_.reserve(codes_.size());
+
+    for (const auto& par : codes_) {
+        if (par.first.size() > static_cast<size_t>(DecodeTable::kMaxCodeLength)) {
+            throw std::runtime_error("Código Huffman demasiado largo para la tabla de decodificación.");
+        }
+        uint32_t code = 0;
+        for (char bit : par.first) {
+            code = (code << 1) | static_cast<uint32_t>(bit == '1');
+        }
+        entries.push_back({code, static_cast<int>(par.first.size()), static_cast<uint32_t>(symbols_.size())});
+        symbols_.push_back(par.second);
     }
-    symbol = it->second;
-    return true;
+    table_.build(entries);
 }
 
-// Verifica si existe algún código almacenado que empiece con este prefijo.
-bool Dictionary::isValidPrefix(const std::string& prefix) const {
-    return prefixes_.find(prefix) != prefixes_.end();
-}
 
-// Restablece el diccionario a un estado vacío (útil antes de cargar un binario).
-void Dictionary::clear() {
-    codes_.clear();
-    prefixes_.clear();
+// Asigna los códigos canónicos en el mismo orden que el compresor: cada código
+// es el anterior + 1, desplazado a la izquierda al crecer la longitud.
+void Dictionary::loadCanonical(const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& lengthCounts) {
+    clear();
+    if (lengthCounts.size() > static_cast<size_t>(DecodeTable::kMaxCodeLength) + 1) {
+        throw std::runtime_error("Código Huffman demasiado largo para la tabla de decodificación.");
+    }
+
+    std::vector<CodeEntry> entries;
+    entries.reserve(symbols.size());
+    uint64_t code = 0;
+    size_t next = 0;
+    for (size_t len = 1; len < lengthCounts.size(); ++len) {
+        code <<= 1;
+        for (uint32_t k = 0; k < lengthCounts[len]; ++k) {
+            if (next >= symbols.size() || code >= (uint64_t(1) << len)) {
+                throw std::runtime_error("Tabla canónica inconsistente en el binario.");
+            }
+            entries.push_back({static_cast<uint32_t>(code), static_cast<int>(len), static_cast<uint32_t>(next)});
+            ++code;
+            ++next;
+        }
+    }
+    if (next != symbols.size()) {
+        throw std::runtime_error("Tabla canónica inconsistente en el binario.");
+    }
+
+    symbols_ = symbols;
+    table_.build(entries);
 }
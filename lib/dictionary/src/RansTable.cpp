@@ -0,0 +1,41 @@
+#include "dictionary/RansTable.hpp"
+
+using namespace dictionary;
+
+void RansTable::load(const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& freqs, int scaleBits) {
+    clear();
+    if (scaleBits <= 0 || scaleBits > static_cast<int>(huffman::formato::kMaxBitsEscalaRANS) ||
+        symbols.size() != freqs.size()) {
+        throw std::runtime_error("Escala inválida en la tabla rANS del binario.");
+    }
+    const uint64_t total = uint64_t(1) << scaleBits;
+    uint64_t sum = 0;
+    for (uint32_t f : freqs) {
+        if (f == 0 || f > total) {
+            throw std::runtime_error("Frecuencia inválida en la tabla rANS del binario.");
+        }
+        sum += f;
+    }
+    if (sum != total) {
+        throw std::runtime_error("Las frecuencias de la tabla rANS no suman su escala.");
+    }
+
+    symbols_ = symbols;
+    slots_.resize(static_cast<size_t>(total));
+    uint32_t start = 0;
+    for (size_t s = 0; s < freqs.size(); ++s) {
+        for (uint32_t k = 0; k < freqs[s]; ++k) {
+            slots_[start + k] = Slot{static_cast<uint32_t>(s), freqs[s], k};
+        }
+        start += freqs[s];
+    }
+    scaleBits_ = scaleBits;
+    mask_ = static_cast<uint32_t>(total - 1);
+}
+
+void RansTable::clear() {
+    symbols_.clear();
+    slots_.clear();
+    scaleBits_ = 0;
+    mask_ = 0;
+}
@@ -0,0 +1,84 @@
+#ifndef BIT_WRITER_HPP
+#define BIT_WRITER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @class BitWriter
+ * @brief Empaquetador de bits MSB-primero con acumulador de 64 bits.
+ *
+ * Recibe códigos ya convertidos a entero (código, longitud), los acumula en
+ * una palabra de 64 bits y vuelca palabras completas de 32 bits a un buffer
+ * propio grande. El buffer solo se escribe al stream cuando se llena o en
+ * flush(), así que no hay una llamada al stream por byte.
+ */
+class BitWriter {
+public:
+    // Tamaño por defecto del buffer de salida: 1 MiB.
+    static constexpr size_t kCapacidadPorDefecto = size_t(1) << 20;
+
+    explicit BitWriter(std::ostream& out, size_t capacidad = kCapacidadPorDefecto);
+    ~BitWriter();
+
+    BitWriter(const BitWriter&) = delete;
+    BitWriter& operator=(const BitWriter&) = delete;
+
+    /**
+     * @brief Escribe los 'longitud' bits bajos de 'codigo' (1 <= longitud <= 64).
+     * Los bits de 'codigo' por encima de 'longitud' deben ser cero.
+     */
+    void write(uint64_t codigo, int longitud) {
+        if (longitud > 32) {
+            write(codigo >> 32, longitud - 32);
+            longitud = 32;
+            codigo &= 0xFFFFFFFFULL;
+        }
+        // Invariante: cuenta < 32 antes de escribir, así que caben hasta 32 bits.
+        acumulador |= codigo << (64 - cuenta - longitud);
+        cuenta += longitud;
+        if (cuenta >= 32) {
+            volcarPalabra();
+        }
+    }
+
+    /**
+     * @brief Completa el último byte con ceros y vuelca todo al stream.
+     */
+    void flush();
+
+    // Bits escritos desde la creación (tras flush() incluye el relleno).
+    uint64_t bitsEscritos() const { return bytesVolcados * 8 + pos * 8 + static_cast<uint64_t>(cuenta); }
+
+private:
+    void volcarPalabra() {
+        if (pos + 4 > buffer.size()) {
+            vaciarBuffer();
+        }
+        uint32_t palabra = static_cast<uint32_t>(acumulador >> 32);
+        buffer[pos]     = static_cast<unsigned char>(palabra >> 24);
+        buffer[pos + 1] = static_cast<unsigned char>(palabra >> 16);
+        buffer[pos + 2] = static_cast<unsigned char>(palabra >> 8);
+        buffer[pos + 3] = static_cast<unsigned char>(palabra);
+        pos += 4;
+        acumulador <<= 32;
+        cuenta -= 32;
+    }
+
+    void vaciarBuffer();
+
+    std::ostream& out;
+    std::vector<unsigned char> buffer;
+    size_t pos;              // bytes ocupados en el buffer
+    uint64_t bytesVolcados;  // bytes ya enviados al stream
+    uint64_t acumulador;     // bits pendientes alineados a la izquierda
+    int cuenta;              // bits válidos en el acumulador
+};
+
+} // namespace huffman
+
+#endif // BIT_WRITER_HPP
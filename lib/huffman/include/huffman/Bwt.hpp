@@ -0,0 +1,43 @@
+#ifndef BWT_HPP
+#define BWT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @brief Arreglo de sufijos de 'texto' con SA-IS, en tiempo lineal.
+ *
+ * 'texto' tiene valores en [0, alfabeto) y se lo considera terminado por un
+ * centinela menor que todos, que no aparece en 'sufijos'. Deja en 'sufijos'
+ * las posiciones de los n sufijos en orden creciente.
+ */
+void arregloSufijos(const uint32_t* texto, size_t n, uint32_t alfabeto, std::vector<int32_t>& sufijos);
+
+/**
+ * @brief Transformada de Burrows-Wheeler de 'texto' (valores en [0, alfabeto)).
+ *
+ * Con el centinela de arregloSufijos la última columna tiene n + 1 valores;
+ * 'salida' la guarda sin el centinela. En 'filas' deja la fila de la matriz
+ * que empieza en cada posición k * formato::pasoPuntosBWT(n, numPuntos): la
+ * primera es la fila donde estaba el centinela y el resto permite invertir
+ * varios tramos a la vez (ver Formato.hpp).
+ */
+void transformarBWT(const std::vector<uint32_t>& texto, uint32_t alfabeto, uint32_t numPuntos,
+                    std::vector<uint32_t>& salida, std::vector<uint32_t>& filas);
+
+/**
+ * @brief Move-to-front y rachas de ceros sobre la salida de transformarBWT.
+ *
+ * Cada valor pasa a su posición en una lista que empieza en 0..alfabeto-1 y
+ * se reordena llevando al frente el último visto. Las rachas de posiciones 0
+ * van en base 2 biyectiva con formato::kSimboloRunA y kSimboloRunB; una posición v > 0 es el símbolo
+ * v + 1. Los símbolos quedan en [0, alfabeto].
+ */
+void codificarMTF(const std::vector<uint32_t>& bwt, uint32_t alfabeto, std::vector<uint32_t>& simbolos);
+
+} // namespace huffman
+
+#endif // BWT_HPP
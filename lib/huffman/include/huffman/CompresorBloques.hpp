@@ -0,0 +1,85 @@
+#ifndef COMPRESOR_BLOQUES_HPP
+#define COMPRESOR_BLOQUES_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "huffman/MatrixHuffman.hpp"
+#include "huffman/TablaCompartida.hpp"
+
+namespace huffman {
+
+// Resumen de una compresión por bloques, para el reporte de main.
+struct EstadisticasCompresion {
+    size_t filas = 0;
+    size_t columnas = 0;
+    uint32_t fondo = 0;
+    size_t simbolosDistintos = 0;
+    size_t bloques = 0;
+    uint64_t bytesSalida = 0;
+};
+
+/**
+ * @brief Comprime un archivo de texto en frames independientes (formato v3).
+ *
+ * Hace una primera pasada en streaming para conocer la codificación, las
+ * dimensiones de la matriz y el fondo, y una segunda que lee bloques de filas
+ * completas (opciones.tamBloque caracteres), construye una tabla Huffman por
+ * bloque y escribe cada frame en cuanto está listo. La memoria usada depende
+ * del tamaño de bloque, no del tamaño del archivo. Con opciones.filasIrregulares
+ * las filas no se rellenan hasta el ancho máximo (ver kFlagIrregular) y, sin
+ * rachas de fondo, no hay primera pasada: lo que mide se completa en la
+ * cabecera al terminar.
+ *
+ * Lanza std::runtime_error si la entrada no se puede leer o la salida no se
+ * puede crear.
+ */
+EstadisticasCompresion comprimirArchivo(
+    const std::string& rutaEntrada,
+    const std::string& rutaSalida,
+    const OpcionesCompresion& opciones = OpcionesCompresion()
+);
+
+/**
+ * @brief Comprime lo que llega por 'entrada' a 'salida' en formato de flujo (versión 4).
+ *
+ * Para pipes: no hay primera pasada ni índice, así que la entrada se lee una
+ * sola vez y cada frame se escribe (y se vacía 'salida') apenas está listo.
+ * Un bloque se cierra al juntar opciones.tamBloque caracteres o cuando la
+ * entrada se queda sin datos por el momento, así que lo que llega no espera
+ * a que llegue más. La memoria depende del tamaño de bloque (y de la fila más
+ * larga), no del total. Las filas van siempre sin relleno y sin rachas de
+ * fondo; la entrada tiene que ser UTF-8 o UTF-16 con BOM.
+ *
+ * Lanza std::runtime_error si la entrada no se puede decodificar o la salida
+ * falla.
+ */
+EstadisticasCompresion comprimirFlujo(
+    std::istream& entrada,
+    std::ostream& salida,
+    const OpcionesCompresion& opciones = OpcionesCompresion()
+);
+
+/**
+ * @brief Entrena una tabla compartida sobre los textos de 'rutasMuestra'.
+ *
+ * Cuenta los caracteres de las muestras como los ve un frame irregular (cada
+ * fila más su fin de fila) y arma una sola tabla canónica, con códigos de a
+ * lo sumo 'longitudMaxima' bits (0 = el límite del decoder). Los ASCII
+ * imprimibles que no aparecen cuentan una vez, para que un archivo con un
+ * carácter poco común pueda seguir usando la tabla.
+ *
+ * Lanza std::runtime_error si alguna muestra no se puede leer.
+ */
+TablaCompartida entrenarTablaCompartida(
+    const std::vector<std::string>& rutasMuestra,
+    uint32_t id,
+    int longitudMaxima = 15
+);
+
+} // namespace huffman
+
+#endif // COMPRESOR_BLOQUES_HPP
@@ -0,0 +1,31 @@
+#ifndef CONTEXTOS_HPP
+#define CONTEXTOS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @brief Agrupa contextos de orden 1 en pocas tablas Huffman.
+ *
+ * 'conteos' tiene una fila por contexto (numContextos x numSimbolos): cuántas
+ * veces aparece cada símbolo detrás de ese contexto. Se eligen como semillas
+ * los contextos más frecuentes, se asigna cada contexto al grupo donde menos
+ * aumenta la entropía y se refina unas vueltas moviendo contextos entre
+ * grupos. Al final se fusionan los grupos cuya separación ahorra menos bits
+ * de los que cuesta guardar una tabla más.
+ *
+ * Devuelve el grupo (0..grupos-1, sin huecos) de cada contexto; a lo sumo
+ * 'maxTablas' grupos. Los contextos sin apariciones quedan en el grupo 0.
+ */
+std::vector<uint8_t> agruparContextos(
+    const std::vector<uint32_t>& conteos,
+    size_t numContextos,
+    size_t numSimbolos,
+    size_t maxTablas);
+
+} // namespace huffman
+
+#endif // CONTEXTOS_HPP
@@ -0,0 +1,356 @@
+#ifndef FORMATO_HPP
+#define FORMATO_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace huffman {
+
+// Constantes del formato .bin compartidas por el encoder (MatrixHuffman) y el
+// decoder (dictionary::Decoder).
+//
+// Los binarios originales no tienen firma: empiezan directamente con
+// <int filas><int cols><int tamDiccionario> y pares de cadenas. Los binarios
+// con cabecera versionada empiezan con la firma "UNCB" seguida de
+// u8 version | u8 flags | varint filas | varint cols, y luego:
+//
+//   version 2 (una sola tabla):  tabla | payload de bits hasta el final
+//   version 3 (por bloques):     [u64 posIndice] frame* | u8 kFrameFin [índice]
+//   version 4 (flujo):           frame* | u8 kFrameFin | varint filas | u8 saltoFinal
+//
+// La versión 4 es la que se escribe sobre un stream (stdin/stdout), donde no
+// se puede leer la entrada dos veces ni volver atrás en la salida: la cabecera
+// no lleva 'filas' ni 'cols' (solo u8 version | u8 flags y la longitud máxima)
+// y siempre tiene kFlagIrregular, sin kFlagIndice ni kFlagRachasFondo. Los
+// frames son los de la versión 3 y cada uno se puede decodificar y escribir
+// apenas llega. El cierre trae el total de filas, para detectar un flujo
+// cortado, y 'saltoFinal' = 1 si el texto terminaba en '\n'.
+//
+// Un varint puede traer bytes 0x80 de relleno (ver escribirVarintFijo): la
+// compresión en una pasada de la versión 3 reserva así 'filas' y 'cols' y
+// los completa al final.
+//
+// Si flags tiene kFlagLongitudMaxima, tras las dimensiones va un u8 con la
+// longitud máxima de código de todas las tablas del archivo (1..32). Así el
+// decoder conoce el tamaño de sus tablas de búsqueda antes de leer ninguna y
+// rechaza las que lo excedan; si es <= 11 cada símbolo se resuelve con una
+// sola consulta.
+//
+// Si flags tiene kFlagRachasFondo, después va el codepoint de fondo como varint
+// (ver más abajo).
+//
+// Si flags tiene kFlagIndice, después va la posición absoluta del índice como
+// entero de 8 bytes little-endian, y el índice se escribe después del frame
+// final:
+//
+//   varint numFrames
+//   por frame: varint offset (absoluto) | varint filas | varint numGrupos
+//     por grupo de filas: varint filaInicial (dentro del frame)
+//                         varint bitInicial (dentro del payload)
+//                         varint simbolos | varint bytesSalida (UTF-8, sin '\n')
+//
+// Con el índice cada grupo se puede decodificar por separado y escribir
+// directamente en su posición final de la salida.
+//
+// Cada frame de la versión 3 es independiente (su propia tabla) y cubre
+// filas completas consecutivas:
+//
+//   u8 kFrameBloque | varint filasDelBloque | tabla
+//   varint bytesPayload | payload de bits (filasDelBloque * cols celdas)
+//
+// Con kFlagIrregular (solo versión 3) las filas no se rellenan hasta 'cols':
+// cada fila son sus propios codepoints, tal cual (el 0 no pasa a fondo),
+// seguidos del símbolo '\n' como fin de fila. El '\n' entra en la tabla de
+// cada frame como cualquier otro símbolo; 'cols' queda como el ancho máximo.
+// En el índice, 'simbolos' cuenta también los fines de fila.
+//
+// Con kFlagRachasFondo (solo versión 3) cada tramo máximo de fondo dentro de
+// una fila se codifica como una racha: el código del fondo en la tabla del
+// frame y, a continuación, la clase de su largo en una segunda tabla que va
+// justo después de la primera:
+//
+//   u8 kFrameBloque | varint filasDelBloque | tabla | tablaRachas
+//   varint bytesPayload | payload de bits
+//
+// La clase k (0..kClasesRacha-1) cubre los largos [2^k, 2^(k+1)) y la siguen
+// k bits extra (MSB-primero) con largo - 2^k. En filas rellenas el relleno y
+// los codepoints 0 cuentan como fondo; en filas irregulares solo el fondo.
+// Una racha nunca cruza el fin de fila. En el índice 'simbolos' sigue
+// contando celdas (no rachas).
+//
+// Con kFlagContexto (solo versión 3) cada frame trae varias tablas y elige
+// la de cada símbolo según el símbolo anterior de la fila (orden 1). Los
+// símbolos anteriores se agrupan en pocas tablas; cada fila empieza con la
+// tabla inicial:
+//
+//   u8 kFrameBloque | varint filasDelBloque | u8 numTablas | tabla*numTablas
+//   [tablaRachas] | [si numTablas > 1: u8 tablaInicial | u8 tablaSiguiente*]
+//   varint bytesPayload | payload de bits
+//
+// 'tablaSiguiente' va una vez por símbolo del frame (la unión de los de todas
+// sus tablas), en orden creciente de codepoint: la tabla con la que se
+// codifica lo que venga después de ese símbolo. Tras una racha de fondo se
+// sigue con la tabla del fondo. Con numTablas == 1 no hay contextos que guardar.
+//
+// Con kFlagRANS (solo versión 3) el payload usa rANS en vez de códigos
+// Huffman. Cada tabla del frame (también la de rachas) se guarda con sus
+// frecuencias (tabla rANS, ver más abajo) y el payload es una serie de
+// streams rANS independientes, uno por grupo de filas:
+//
+//   u8 kFrameBloque | varint filasDelBloque | [u8 numTablas] | tablaRANS*
+//   [tablaRachasRANS] | [contextos] | varint numGrupos
+//   por grupo: varint filas | varint bytes
+//   varint bytesPayload | payload (los streams de los grupos, seguidos)
+//
+// Cada stream empieza con los kEstadosRANS estados de 32 bits (little-endian)
+// y sigue con los bytes de renormalización en orden de lectura. Las
+// operaciones (símbolos, clases de racha y bits extra) usan los estados por
+// turno: la i-ésima del grupo, el estado i % kEstadosRANS. Un estado decodifica
+// con su tabla el slot x & (2^bits - 1); mientras quede por debajo de
+// kCotaRANS se le agrega un byte del stream. Los bits extra de las rachas van
+// en tramos de a lo sumo kBitsCrudosRANS bits, del más alto al más bajo, como
+// símbolos de frecuencia 1 sobre 2^tramo. Al terminar el grupo todos los
+// estados vuelven a valer kCotaRANS. En el índice 'bitInicial' es el inicio
+// del stream del grupo (múltiplo de 8).
+//
+// Con kFlagIntercalado (solo versión 3, sin kFlagRANS) el payload Huffman de
+// cada grupo de filas se reparte en kStreamsIntercalados streams de bits: el
+// código i-ésimo del grupo (símbolo o clase de racha, con sus bits extra) va
+// al stream i % kStreamsIntercalados. El decoder lleva un lector por stream y
+// los códigos seguidos no esperan uno la longitud del otro. Los tamaños de los
+// streams van en una tabla de saltos antes del payload:
+//
+//   u8 kFrameBloque | varint filasDelBloque | [u8 numTablas] | tabla*
+//   [tablaRachas] | [contextos] | varint numGrupos
+//   por grupo: varint filas | varint bytes[kStreamsIntercalados]
+//   varint bytesPayload | payload (por grupo, sus streams seguidos)
+//
+// Cada stream se completa hasta un byte entero. En el índice 'bitInicial' es
+// el inicio del primer stream del grupo (múltiplo de 8).
+//
+// Un frame kFrameLZ (solo versión 3, sin rachas, contextos, rANS ni streams
+// intercalados) pasa las filas por LZ77 antes de Huffman. Cada grupo de filas
+// del índice es su texto UTF-8 tal cual lo escribe el decoder, con las filas
+// separadas por '\n' y rellenas hasta 'cols' con el fondo si no hay
+// kFlagIrregular. Ese texto se parte en literales (un codepoint) y copias de
+// 'largo' bytes desde 'distancia' bytes atrás, que nunca salen del grupo:
+//
+//   u8 kFrameLZ | varint filasDelBloque | tablaLiterales | tablaDistancias
+//   varint numGrupos | (varint filas | varint bytesTexto) * numGrupos
+//   varint bytesPayload | payload de bits
+//
+// Los grupos van seguidos en un solo stream de bits (en el índice,
+// 'bitInicial' es donde empieza cada uno) y terminan tras 'bytesTexto' bytes.
+// La tabla de literales tiene los codepoints y, desde kSimboloLargoLZ, las
+// clases de largo de copia; tras una clase van sus bits extra, el código de
+// la clase de distancia en la segunda tabla y los bits extra de esta. Largos
+// (largo - kMinLargoLZ) y distancias (distancia - 1) usan las clases de
+// claseLZ: los valores < 8 son su propia clase y los demás se parten en
+// mitades de cada potencia de 2. Una copia puede solaparse consigo misma
+// (distancia < largo) y termina en el límite de un codepoint.
+//
+// Un frame kFrameBWT (mismas restricciones que kFrameLZ) es un solo grupo del
+// índice: el texto del bloque, armado como en kFrameLZ pero en codepoints,
+// pasa por la transformada de Burrows-Wheeler, move-to-front y rachas de
+// ceros antes de Huffman:
+//
+//   u8 kFrameBWT | varint filasDelBloque | varint alfabeto
+//   varint codepoint * alfabeto (el primero tal cual, el resto la diferencia
+//   con el anterior) | tablaMTF | varint largoTexto
+//   varint numPuntos | varint fila * numPuntos | varint bytesPayload | payload
+//
+// La transformada usa el índice de cada codepoint en el alfabeto (creciente)
+// y un centinela final menor que todos; la última columna se guarda sin él.
+// El punto k es la fila de la matriz que empieza en la posición
+// k * pasoPuntosBWT(largoTexto, numPuntos) del texto: el 0 es la fila donde
+// estaba el centinela y con los demás el decoder invierte varios tramos a la
+// vez. En move-to-front la lista empieza en 0..alfabeto-1. Una racha de r
+// posiciones 0 va como los dígitos de r en base 2 biyectiva, del menos
+// significativo al más: kSimboloRunA es el dígito 1 y kSimboloRunB el 2. Una
+// posición v > 0 es el símbolo v + 1. La tabla MTF guarda esos símbolos en
+// lugar de codepoints.
+//
+// Un frame kFrameCompartido (solo versión 3, sin rachas, contextos ni rANS)
+// es un kFrameBloque sin su tabla: usa la de un archivo de tablas compartidas
+// (ver abajo), que se nombra por su id y el hash de su tabla:
+//
+//   u8 kFrameCompartido | varint filasDelBloque | varint id | u32 hash
+//   [grupos, con kFlagIntercalado] | varint bytesPayload | payload de bits
+//
+// El decoder tiene que conocer ese archivo de antemano; si el hash no
+// coincide con el de la tabla que tiene con ese id, el frame no se decodifica.
+//
+// Un archivo de tablas compartidas (comando train) empieza con la firma
+// "UNCT" y guarda una tabla canónica entrenada sobre textos de muestra:
+//
+//   u8 kVersionTablas | varint id | u32 hash | tabla canónica
+//
+// 'hash' es FNV-1a de 32 bits sobre los bytes de la tabla canónica, y los u32
+// van little-endian.
+//
+// Una tabla rANS se guarda como:
+//
+//   varint numSimbolos
+//   si numSimbolos > 0:
+//     u8 bitsEscala | (varint simbolo | varint frecuencia)[numSimbolos]
+//
+// Las frecuencias son >= 1 y suman exactamente 2^bitsEscala; los símbolos
+// ocupan los slots en el orden en que aparecen en la tabla.
+//
+// Una tabla canónica se guarda como:
+//
+//   varint numSimbolos
+//   si numSimbolos > 0:
+//     u8 longitudMaxima | varint cantidadPorLongitud[1..longitudMaxima]
+//     varint simbolo[numSimbolos]     (codepoints, en orden canónico)
+//
+// Los varint son LEB128 sin signo (7 bits por byte, el bit alto indica que
+// sigue otro byte).
+namespace formato {
+
+constexpr char kFirma[4] = {'U', 'N', 'C', 'B'};
+
+constexpr uint8_t kVersionCanonica = 2;
+constexpr uint8_t kVersionBloques = 3;
+constexpr uint8_t kVersionFlujo = 4;
+
+// Archivos de tablas compartidas.
+constexpr char kFirmaTablas[4] = {'U', 'N', 'C', 'T'};
+constexpr uint8_t kVersionTablas = 1;
+
+// La tabla se guarda como longitudes de código canónico.
+constexpr uint8_t kFlagCanonico = 0x01;
+// El archivo trae índice de frames y grupos de filas (solo versión 3).
+constexpr uint8_t kFlagIndice = 0x02;
+// Filas de largo variable con símbolo de fin de fila (solo versión 3).
+constexpr uint8_t kFlagIrregular = 0x04;
+// La cabecera declara la longitud máxima de código de sus tablas.
+constexpr uint8_t kFlagLongitudMaxima = 0x08;
+// Tramos de fondo codificados como rachas con su propia tabla (solo versión 3).
+constexpr uint8_t kFlagRachasFondo = 0x10;
+
+// Tablas elegidas por el símbolo anterior (orden 1, solo versión 3).
+constexpr uint8_t kFlagContexto = 0x20;
+
+// Payload con rANS en lugar de códigos Huffman (solo versión 3).
+constexpr uint8_t kFlagRANS = 0x40;
+
+// Payload Huffman repartido en varios streams por grupo (solo versión 3).
+constexpr uint8_t kFlagIntercalado = 0x80;
+
+// Clases de largo de racha: 2^31 ya supera cualquier ancho de fila.
+constexpr uint32_t kClasesRacha = 31;
+
+// Tablas por frame como máximo con kFlagContexto.
+constexpr uint32_t kMaxTablasContexto = 16;
+
+// Estados rANS intercalados por stream: mientras uno espera su consulta y su
+// multiplicación, el decoder ya avanza con el siguiente.
+constexpr uint32_t kEstadosRANS = 4;
+
+// Cota inferior de un estado rANS normalizado (estados de 32 bits,
+// renormalización de a un byte).
+constexpr uint32_t kCotaRANS = uint32_t(1) << 23;
+
+// Bits de escala admitidos en una tabla rANS.
+constexpr uint32_t kMaxBitsEscalaRANS = 22;
+
+// Bits extra por operación rANS como máximo.
+constexpr uint32_t kBitsCrudosRANS = 16;
+
+// LZ77: largo mínimo y máximo de una copia y hasta cuántos bytes atrás
+// puede copiar. kVentanaLZ también es la memoria que necesita el decoder.
+constexpr uint32_t kMinLargoLZ = 3;
+constexpr uint32_t kMaxLargoLZ = kMinLargoLZ + (uint32_t(1) << 24) - 1;
+constexpr uint32_t kVentanaLZ = uint32_t(1) << 17;
+
+// Clases de largo (en la tabla de literales, desde kSimboloLargoLZ) y de
+// distancia de una copia LZ77.
+constexpr uint32_t kSimboloLargoLZ = 0x110000;
+constexpr uint32_t kClasesLargoLZ = 50;
+constexpr uint32_t kClasesDistanciaLZ = 36;
+
+// Símbolos de una racha de ceros tras move-to-front (kFrameBWT).
+constexpr uint32_t kSimboloRunA = 0;
+constexpr uint32_t kSimboloRunB = 1;
+
+// Puntos de entrada de la inversa BWT por frame, y el máximo que se acepta.
+constexpr uint32_t kPuntosBWT = 16;
+constexpr uint32_t kMaxPuntosBWT = 64;
+
+// Streams de bits por grupo con kFlagIntercalado.
+constexpr uint32_t kStreamsIntercalados = 4;
+
+// Tipos de frame de la versión 3.
+constexpr uint8_t kFrameFin = 0x00;
+constexpr uint8_t kFrameBloque = 0x01;
+constexpr uint8_t kFrameLZ = 0x02;
+constexpr uint8_t kFrameBWT = 0x03;
+constexpr uint8_t kFrameCompartido = 0x04;
+
+// Grupo de filas consecutivas dentro de un frame, decodificable por separado.
+struct GrupoIndice {
+    uint64_t filaInicial = 0;   // relativa al frame
+    uint64_t bitInicial = 0;    // relativo al inicio del payload del frame
+    uint64_t simbolos = 0;      // celdas del grupo (con rachas, las que cubren)
+    uint64_t bytesSalida = 0;   // bytes UTF-8 de esas celdas (sin saltos de línea)
+};
+
+struct FrameIndice {
+    uint64_t offset = 0;        // posición absoluta del frame en el archivo
+    uint64_t filas = 0;
+    std::vector<GrupoIndice> grupos;
+};
+
+// Clase LZ77 de un valor: los menores que 8 son su propia clase; el resto,
+// con 2^k <= valor < 2^(k+1), va a 8 + 2(k - 3) + el bit siguiente al más alto.
+uint32_t claseLZ(uint32_t valor);
+// Bits extra y primer valor de una clase LZ77.
+uint32_t bitsExtraLZ(uint32_t clase);
+uint32_t baseLZ(uint32_t clase);
+
+// Posiciones del texto entre dos puntos de entrada de la inversa BWT.
+size_t pasoPuntosBWT(size_t largo, uint32_t numPuntos);
+
+// Entero sin signo en LEB128: 7 bits por byte, bit alto = "sigue otro byte".
+void escribirVarint(std::ostream& out, uint64_t valor);
+
+// El mismo varint en kBytesVarintFijo bytes (con relleno), para un valor que
+// se sobrescribe después en el mismo lugar.
+constexpr size_t kBytesVarintFijo = 10;
+void escribirVarintFijo(std::ostream& out, uint64_t valor);
+
+// Escribe una tabla canónica: los codepoints ya en orden canónico (longitud
+// creciente) y la longitud de código de cada uno. Sin símbolos escribe una
+// tabla vacía.
+void escribirTablaCanonica(
+    std::ostream& out,
+    const std::vector<uint32_t>& simbolos,
+    const std::vector<uint32_t>& longitudes);
+
+// Escribe una tabla rANS: los símbolos en el orden de sus slots y sus
+// frecuencias, que deben sumar 2^bitsEscala.
+void escribirTablaRANS(
+    std::ostream& out,
+    const std::vector<uint32_t>& simbolos,
+    const std::vector<uint32_t>& frecuencias,
+    int bitsEscala);
+
+// Escribe el índice de frames (ver arriba).
+void escribirIndice(std::ostream& out, const std::vector<FrameIndice>& frames);
+
+// Escribe un entero de 8 bytes little-endian (posición del índice).
+void escribirU64(std::ostream& out, uint64_t valor);
+
+// Escribe un entero de 4 bytes little-endian (hash de una tabla compartida).
+void escribirU32(std::ostream& out, uint32_t valor);
+
+// FNV-1a de 32 bits: identifica el contenido de una tabla compartida.
+uint32_t hashFNV1a(const void* datos, size_t bytes);
+
+} // namespace formato
+
+} // namespace huffman
+
+#endif // FORMATO_HPP
@@ -1,53 +1,40 @@
 //HuffmanNode.hpp
 #pragma once
 
-#include <memory>   // Para std::shared_ptr
-#include <string>   // <-- AÑADIDO: Para poder usar std::string
+#include <cstdint>  // Para uint64_t / int32_t
 
 namespace huffman {
 
 /**
- * @class HuffmanNode
+ * @struct HuffmanNode
  * @brief Representa un solo nodo en el árbol de Huffman.
  * Puede ser un nodo hoja (con un símbolo) o un nodo interno (con hijos).
+ *
+ * Los nodos viven todos en un mismo arreglo: las hojas ocupan [0, n) y los
+ * nodos internos [n, 2n - 1), en el orden en que se crean. Los hijos se
+ * referencian por índice dentro de ese arreglo, así que construir el árbol
+ * no reserva memoria por nodo y siempre hijo < padre.
  */
-class HuffmanNode {
-public:
-    // --- Tipos de datos actualizados ---
-    // 1. Usamos 'std::string' para el símbolo (ej: "2f", "4h").
-    // 2. Usamos 'int' para la frecuencia.
-    // 3. Usamos std::shared_ptr para gestionar la memoria de los hijos.
-    // ------------------------------------
+struct HuffmanNode {
+    // Frecuencia de la hoja, o suma de las de sus hijos.
+    uint64_t frequency = 0;
 
-    std::string data;
-    int frequency;
+    // Índices de los hijos en el arreglo de nodos; -1 en las hojas.
+    int32_t left = -1;
+    int32_t right = -1;
 
-    // Punteros a los nodos hijos
-    std::shared_ptr<HuffmanNode> left;
-    std::shared_ptr<HuffmanNode> right;
+    // En las hojas, posición del símbolo en la entrada.
+    uint32_t symbol = 0;
 
-    /**
-     * @brief Constructor para un nodo HOJA.
-     * @param data El símbolo (token) que representa este nodo.
-     * @param frequency La frecuencia de aparición de este símbolo.
-     */
-    // Nota: Usamos "const std::string&" para pasar el string de
-    // forma eficiente, sin crear copias innecesarias.
-    HuffmanNode(const std::string& data, int frequency);
-
-    /**
-     * @brief Constructor para un nodo INTERNO.
-     * @param left El hijo izquierdo.
-     * @param right El hijo derecho.
-     */
-    HuffmanNode(std::shared_ptr<HuffmanNode> left, std::shared_ptr<HuffmanNode> right);
+    // Profundidad en el árbol (= longitud del código en las hojas).
+    uint32_t depth = 0;
 
     /**
      * @brief Comprueba si este nodo es una hoja.
-     * @return true si ambos hijos son nulos (nullptr), false en caso contrario.
+     * @return true si no tiene hijos.
      */
-    bool isLeaf() const;
+    bool isLeaf() const { return left < 0; }
 
-}; // fin de la clase HuffmanNode
+}; // fin de la estructura HuffmanNode
 
 } // fin del namespace huffman
\ No newline at end of file
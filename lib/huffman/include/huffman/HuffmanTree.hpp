@@ -6,83 +6,59 @@
 
 // --- Librerías estándar que necesitaremos ---
 
-#include <memory>   // Para std::shared_ptr
-#include <string>   // Para std::string
-#include <map>      // Para el mapa de frecuencias y el mapa de códigos
-#include <vector>   // Requerido por std::priority_queue
-#include <queue>    // Para std::priority_queue (la clave del algoritmo)
+#include <cstddef>  // Para size_t
+#include <cstdint>  // Para uint32_t
 
 
 namespace huffman {
 
-// --- Ayudante: Comparador para la Cola de Prioridad ---
-
-/**
- * @struct CompareNode
- * @brief Objeto de función para ordenar la cola de prioridad (min-heap).
- *
- * std::priority_queue por defecto es un "max-heap" (ordena de mayor a menor).
- * Para Huffman, necesitamos un "min-heap" (ordenar de menor a mayor frecuencia).
- *
- * Este struct le dice a la cola de prioridad que considere "mayor"
- * al nodo que tenga la frecuencia más alta.
- */
-struct CompareNode {
-    // Sobrecarga del operador ()
-    bool operator()(const std::shared_ptr<HuffmanNode>& a, const std::shared_ptr<HuffmanNode>& b) const {
-        // Devuelve true si la frecuencia de 'a' es MAYOR que la de 'b'.
-        // Esto hace que los nodos con MENOR frecuencia tengan prioridad.
-        return a->frequency > b->frequency;
-    }
-};
-
-
 // --- Definición de la Clase Principal ---
 
 /**
  * @class HuffmanTree
- * @brief Gestiona la construcción del árbol de Huffman y la
- * generación de los códigos binarios para cada símbolo.
+ * @brief Construcción del árbol de Huffman sobre un arreglo de nodos. Solo
+ * devuelve longitudes de código: los códigos son canónicos y los arma quien
+ * escribe la tabla (ver construirTablaCanonica en CompresorBloques.cpp).
  */
 class HuffmanTree {
 public:
     /**
-     * @brief Constructor.
-     * Construye el árbol de Huffman inmediatamente al ser creado.
-     * @param frequencies Un mapa donde la clave es el símbolo (string)
-     * y el valor es su frecuencia (int).
+     * @brief Calcula las longitudes de código sin construir ningún objeto.
+     *
+     * 'nodes' debe tener lugar para 2n - 1 nodos y traer en [0, n) las hojas
+     * con su 'frequency' (> 0) y su 'symbol' (posición en 'lengths'). Las hojas
+     * se ordenan por frecuencia y se combinan con dos colas: la de hojas y la
+     * de nodos internos, que se crean ya en orden, así que la combinación es
+     * O(n). Las profundidades se calculan sin recursión. No reserva memoria;
+     * quien llama puede reutilizar 'nodes' entre tablas.
+     *
+     * Con una sola hoja su longitud es 1 (código "0", como en el árbol).
+     *
+     * Con maxLength > 0 ningún código supera effectiveMaxLength(n, maxLength)
+     * bits: los que se pasan se recortan al límite y se alargan códigos más
+     * cortos hasta que la desigualdad de Kraft vuelve a cerrar; después las
+     * longitudes se reparten de nuevo por frecuencia (las más largas a los
+     * símbolos menos frecuentes). En ese caso 'depth' de las hojas es la
+     * longitud final y ya no coincide con los enlaces del árbol.
      */
-    HuffmanTree(const std::map<std::string, int>& frequencies);
+    static void computeCodeLengths(HuffmanNode* nodes, size_t n, uint32_t* lengths, int maxLength = 0);
 
     /**
-     * @brief Obtiene el mapa de códigos de Huffman generados.
-     * @return Un mapa constante donde la clave es el símbolo (ej: "2f")
-     * y el valor es su código binario (ej: "011").
+     * @brief Límite que se aplica de verdad con 'n' símbolos: nunca menos de
+     * ceil(log2(n)) bits (si no, no hay códigos para todos) ni más de
+     * kMaxLimitedLength.
      */
-    const std::map<std::string, std::string>& getCodes() const;
-
-private:
-    // El nodo raíz de nuestro árbol.
-    std::shared_ptr<HuffmanNode> root;
-
-    // Mapa para almacenar los códigos generados (Ej: "2f" -> "01")
-    std::map<std::string, std::string> huffmanCodes;
+    static int effectiveMaxLength(size_t n, int maxLength);
 
-    /**
-     * @brief Función privada que construye el árbol.
-     * Es llamada por el constructor.
-     * @param frequencies El mapa de frecuencias.
-     */
-    void buildTree(const std::map<std::string, int>& frequencies);
+    // Longitud máxima que admite el modo limitado (la del decodificador).
+    static constexpr int kMaxLimitedLength = 32;
 
+private:
     /**
-     * @brief Función recursiva privada para generar los códigos.
-     * Recorre el árbol (DFS) y almacena los códigos en 'huffmanCodes'.
-     * @param node El nodo actual que se está visitando.
-     * @param currentCode El código binario acumulado hasta este nodo.
+     * @brief Ajusta las longitudes de las hojas (ya ordenadas por frecuencia)
+     * para que ninguna supere 'maxLength' (ver computeCodeLengths).
      */
-    void generateCodes(std::shared_ptr<HuffmanNode> node, const std::string& currentCode);
-
-}; // fin de la clase HuffmanTree
+    static void limitCodeLengths(HuffmanNode* nodes, size_t n, int maxLength);
+};
 
 } // fin del namespace huffman
\ No newline at end of file
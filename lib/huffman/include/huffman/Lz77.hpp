@@ -0,0 +1,61 @@
+#ifndef LZ77_HPP
+#define LZ77_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace huffman {
+
+// Un token del parseo LZ77: un literal ('largo' == 0 y 'valor' su codepoint)
+// o una copia de 'largo' bytes desde 'valor' bytes atrás.
+struct TokenLZ {
+    uint32_t largo;
+    uint32_t valor;
+};
+
+// Niveles de BuscadorLZ: 1 es el más rápido y 9 el que más comprime.
+constexpr int kMinNivelLZ = 1;
+constexpr int kMaxNivelLZ = 9;
+
+/**
+ * @class BuscadorLZ
+ * @brief Parseo LZ77 de texto UTF-8 con cadenas de hash.
+ *
+ * Cada posición se encadena con las anteriores de igual hash de 3 bytes y se
+ * prueban hasta cierta cantidad de candidatos por posición. Desde el nivel 4
+ * el parseo es perezoso: antes de aceptar una copia mira si empezando un
+ * carácter después sale una más larga. Solo se buscan copias que empiecen y
+ * terminen en el límite de un codepoint, así que cada literal es un carácter
+ * entero. Las tablas se reutilizan entre llamadas sin volver a limpiarlas.
+ */
+class BuscadorLZ {
+public:
+    explicit BuscadorLZ(int nivel);
+
+    /**
+     * @brief Parsea 'texto' (UTF-8 válido) y agrega sus tokens a 'tokens'.
+     *
+     * Cada llamada empieza sin historia: ninguna copia sale de 'texto', que
+     * se decodifica por separado (un grupo de filas).
+     */
+    void parsear(const unsigned char* texto, size_t n, std::vector<TokenLZ>& tokens);
+
+private:
+    uint32_t buscar(const unsigned char* texto, size_t n, size_t i, uint32_t& distancia) const;
+    void insertar(const unsigned char* texto, size_t n, size_t i);
+
+    uint32_t cadena_;       // candidatos probados por posición
+    uint32_t suficiente_;   // largo con el que se deja de buscar
+    bool perezoso_;
+
+    // Posiciones absolutas (base_ + i) para no limpiar las tablas en cada
+    // llamada: lo anterior a base_ es de otro texto y se ignora.
+    std::vector<uint32_t> cabeza_;
+    std::vector<uint32_t> previa_;
+    uint32_t base_ = 1;
+};
+
+} // namespace huffman
+
+#endif // LZ77_HPP
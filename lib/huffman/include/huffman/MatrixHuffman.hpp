@@ -3,34 +3,80 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <memory>
+#include "huffman/TablaCompartida.hpp"
 
 namespace huffman {
 
-struct Triplete {
-    int fila;
-    int col;
-    std::string valor;
-};
+// Opciones del formato de salida.
+struct OpcionesCompresion {
+    // Longitud máxima de código de las tablas canónicas (0 = sin límite). Se sube
+    // sola si no alcanza para todos los símbolos; el valor usado queda en la
+    // cabecera. Códigos cortos permiten decodificar con una sola consulta.
+    int longitudMaxima = 15;
+
+    // Compresión por bloques (comprimirArchivo): caracteres de entrada que
+    // se juntan, como mínimo, en cada frame. Cada bloque lleva su propia tabla.
+    size_t tamBloque = size_t(1) << 20;
+
+    // Hilos para codificar bloques en paralelo (0 = todos los núcleos).
+    // La salida es la misma con cualquier valor.
+    size_t hilos = 1;
+
+    // Filas de largo variable (comprimirArchivo): cada fila se guarda sin
+    // relleno, terminada por el símbolo '\n'. El trabajo y el tamaño del .bin
+    // dependen de los caracteres reales y no del rectángulo filas x columnas;
+    // al decodificar se recuperan las filas sin el relleno de fondo.
+    bool filasIrregulares = false;
+
+    // Rachas de fondo (comprimirArchivo): cada tramo de fondo dentro de una
+    // fila se codifica como un símbolo de fondo más su largo, con una segunda
+    // tabla para los largos. En entradas con mucho relleno o espacios el
+    // payload y las iteraciones del decoder bajan en proporción al largo medio
+    // de las rachas.
+    bool rachasFondo = false;
+
+    // Tablas por contexto de orden 1 (comprimirArchivo): con más de una, cada
+    // frame agrupa los símbolos anteriores en hasta esta cantidad de tablas
+    // (máximo formato::kMaxTablasContexto) y cada símbolo se codifica con la
+    // tabla del que lo precede en la fila. Mejora la razón en texto natural a
+    // costa de guardar más tablas; 1 = una sola tabla por frame.
+    size_t tablasContexto = 1;
 
-// Función principal que decide si exportar a TXT o BIN
-std::map<std::string, std::string> procesarMatrizYExportar(
-    const std::vector<Triplete>& datosDispersos,
-    const std::string& valorMasFrecuente,
-    int totalFilas,
-    int totalCols,
-    const std::string& nombreArchivoSalida
-);
-
-// Función interna para la lógica binaria
-void exportarBinario(
-    const std::string& nombreArchivo,
-    int filas,
-    int cols,
-    const std::string& valorFondo,
-    const std::vector<Triplete>& tripletas,
-    const std::map<std::string, std::string>& codigos
-);
+    // rANS en vez de códigos Huffman (comprimirArchivo): las tablas guardan
+    // frecuencias y cada símbolo cuesta lo que indica su probabilidad, no un
+    // número entero de bits. Gana sobre todo con símbolos muy frecuentes como
+    // el fondo. No usa longitudMaxima.
+    bool rans = false;
+
+    // Streams intercalados (comprimirArchivo, solo Huffman): el payload de
+    // cada grupo de filas se reparte en formato::kStreamsIntercalados streams
+    // de bits que el decoder lee a la vez. Los códigos seguidos no dependen
+    // uno de la longitud del otro y la CPU solapa sus consultas. Con rans no
+    // hace falta: rANS ya intercala sus estados.
+    bool intercalado = false;
+
+    // Nivel LZ77 (comprimirArchivo): con 1..9 cada grupo de filas pasa por
+    // LZ77 antes de Huffman y las repeticiones (filas parecidas, palabras que
+    // vuelven) se guardan como copias de lo ya escrito. Más alto busca más y
+    // comprime mejor; 0 = sin LZ77. Reemplaza a rachasFondo, tablasContexto,
+    // rans e intercalado.
+    int nivelLZ = 0;
+
+    // Burrows-Wheeler (comprimirArchivo): cada bloque pasa por la transformada,
+    // move-to-front y rachas de ceros antes de Huffman. Suele comprimir más
+    // que LZ77 en texto natural; el bloque entero es la unidad que se
+    // decodifica, así que tamBloque regula memoria y paralelismo. Tiene
+    // prioridad sobre nivelLZ y reemplaza a las mismas opciones.
+    bool bwt = false;
+
+    // Tabla compartida (comprimirArchivo, comando train): cada bloque cuyos
+    // símbolos estén todos en ella la nombra en lugar de llevar su propia
+    // tabla, salvo que la propia salga más barata. Se carga una vez y sirve
+    // para cualquier cantidad de archivos. Reemplaza a rachasFondo,
+    // tablasContexto, rans, nivelLZ y bwt.
+    std::shared_ptr<const TablaCompartida> tablaCompartida;
+};
 
 } // namespace huffman
 
@@ -0,0 +1,68 @@
+#ifndef POOL_HILOS_HPP
+#define POOL_HILOS_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @class PoolHilos
+ * @brief Conjunto fijo de hilos que ejecuta tareas en orden de llegada.
+ *
+ * Se usa para codificar bloques en paralelo: cada tarea es independiente y
+ * devuelve su resultado por un std::future, así quien encola decide en qué
+ * orden consumir los resultados (y la salida no depende de los hilos).
+ */
+class PoolHilos {
+public:
+    /**
+     * @param hilos Cantidad de hilos; 0 usa std::thread::hardware_concurrency().
+     */
+    explicit PoolHilos(size_t hilos);
+
+    // Termina las tareas pendientes y une los hilos.
+    ~PoolHilos();
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    size_t hilos() const { return trabajadores.size(); }
+
+    /**
+     * @brief Encola una tarea y devuelve un future con su resultado.
+     * Las excepciones de la tarea se propagan al hacer get() sobre el future.
+     */
+    template <class F>
+    auto enviar(F tarea) -> std::future<decltype(tarea())> {
+        using Resultado = decltype(tarea());
+        auto paquete = std::make_shared<std::packaged_task<Resultado()>>(std::move(tarea));
+        std::future<Resultado> futuro = paquete->get_future();
+        encolar([paquete]() { (*paquete)(); });
+        return futuro;
+    }
+
+    // Resuelve el valor 0 de "--threads" a la cantidad de núcleos disponibles.
+    static size_t resolverHilos(size_t hilos);
+
+private:
+    void encolar(std::function<void()> tarea);
+    void bucleTrabajador();
+
+    std::vector<std::thread> trabajadores;
+    std::deque<std::function<void()>> tareas;
+    std::mutex mutex;
+    std::condition_variable hayTarea;
+    bool cerrando = false;
+};
+
+} // namespace huffman
+
+#endif // POOL_HILOS_HPP
@@ -0,0 +1,51 @@
+#ifndef RANS_HPP
+#define RANS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace huffman {
+
+// Una operación de un stream rANS ya preparada para codificar sin dividir:
+// la división por la frecuencia se hace multiplicando por su recíproco.
+struct OperacionRANS {
+    uint32_t xMaximo;       // el estado se renormaliza hasta quedar debajo
+    uint32_t reciproco;
+    uint32_t corrimiento;
+    uint32_t sesgo;
+    uint32_t complemento;   // 2^bitsEscala - frecuencia
+};
+
+// Operación para un símbolo que ocupa los slots [inicio, inicio + frecuencia)
+// de 2^bitsEscala. Los bits extra de una racha son una operación con
+// frecuencia 1 e 'inicio' igual a su valor.
+OperacionRANS operacionRANS(uint32_t inicio, uint32_t frecuencia, uint32_t bitsEscala);
+
+// Bits de escala para una tabla de 'numSimbolos' símbolos: 12 para alfabetos
+// chicos, más si hace falta precisión, y siempre al menos uno por símbolo.
+int bitsEscalaRANS(size_t numSimbolos);
+
+/**
+ * @brief Escala las frecuencias para que sumen exactamente 2^bitsEscala.
+ *
+ * Cada símbolo con frecuencia > 0 queda con al menos 1. Lo que sobra o falta
+ * tras redondear se ajusta en los símbolos más frecuentes, donde cambia menos
+ * el costo. Requiere 2^bitsEscala >= símbolos con frecuencia > 0.
+ */
+void normalizarFrecuencias(
+    const std::vector<uint64_t>& frecuencias,
+    int bitsEscala,
+    std::vector<uint32_t>& normalizadas);
+
+/**
+ * @brief Codifica 'ops' como un stream rANS (ver Formato.hpp) y lo agrega a 'salida'.
+ *
+ * 'ops' va en el orden en que las lee el decoder; rANS codifica al revés, así
+ * que el stream se arma desde el final en un buffer propio.
+ */
+void codificarRANS(const std::vector<OperacionRANS>& ops, std::vector<unsigned char>& salida);
+
+} // namespace huffman
+
+#endif // RANS_HPP
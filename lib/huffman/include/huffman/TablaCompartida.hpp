@@ -0,0 +1,45 @@
+#ifndef TABLA_COMPARTIDA_HPP
+#define TABLA_COMPARTIDA_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @brief Tabla canónica entrenada de antemano y guardada aparte (ver Formato.hpp).
+ *
+ * Los frames que la usan la nombran por 'id' y 'hash' en lugar de llevarla
+ * adentro: con muchos archivos chicos la tabla se paga una sola vez y el
+ * compresor no arma un árbol por archivo.
+ */
+struct TablaCompartida {
+    uint32_t id = 0;
+    uint32_t hash = 0;                  // FNV-1a de la tabla serializada
+    int longitudMaxima = 0;
+    std::vector<uint32_t> simbolos;     // codepoints en orden canónico
+    std::vector<uint32_t> longitudes;   // longitud de código de cada uno
+};
+
+// Hash de la tabla tal como se serializa (el que va en 'hash').
+uint32_t hashTablaCompartida(const TablaCompartida& tabla);
+
+/**
+ * @brief Guarda la tabla en 'ruta' con el formato de archivo de tablas.
+ *
+ * Lanza std::runtime_error si no se puede escribir.
+ */
+void guardarTablaCompartida(const std::string& ruta, const TablaCompartida& tabla);
+
+/**
+ * @brief Carga un archivo de tablas y verifica su hash.
+ *
+ * Lanza std::runtime_error si el archivo no existe, no tiene la firma o la
+ * versión esperadas, o su tabla no coincide con el hash guardado.
+ */
+TablaCompartida cargarTablaCompartida(const std::string& ruta);
+
+} // namespace huffman
+
+#endif // TABLA_COMPARTIDA_HPP
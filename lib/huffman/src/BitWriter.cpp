@@ -0,0 +1,47 @@
+#include "huffman/BitWriter.hpp"
+
+namespace huffman {
+
+BitWriter::BitWriter(std::ostream& out, size_t capacidad)
+    : out(out),
+      buffer(capacidad < 4 ? 4 : capacidad),
+      pos(0),
+      bytesVolcados(0),
+      acumulador(0),
+      cuenta(0)
+{
+}
+
+// Si el usuario olvidó llamar a flush() no perdemos los bits pendientes.
+BitWriter::~BitWriter()
+{
+    flush();
+}
+
+void BitWriter::flush()
+{
+    // Los bits que quedan en el acumulador (< 32) salen byte a byte;
+    // el último byte se completa con ceros.
+    while (cuenta > 0) {
+        if (pos == buffer.size()) {
+            vaciarBuffer();
+        }
+        buffer[pos++] = static_cast<unsigned char>(acumulador >> 56);
+        acumulador <<= 8;
+        cuenta = cuenta > 8 ? cuenta - 8 : 0;
+    }
+    acumulador = 0;
+    vaciarBuffer();
+    out.flush();
+}
+
+void BitWriter::vaciarBuffer()
+{
+    if (pos > 0) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(pos));
+        bytesVolcados += pos;
+        pos = 0;
+    }
+}
+
+} // namespace huffman
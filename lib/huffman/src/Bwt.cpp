@@ -0,0 +1,218 @@
+#include "huffman/Bwt.hpp"
+#include "huffman/Formato.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace huffman {
+
+namespace {
+
+constexpr int32_t kVacio = -1;
+
+// Inicio (o fin, con 'finales') del bucket de cada valor en el arreglo.
+void calcularBuckets(const uint32_t* texto, size_t n, uint32_t alfabeto, std::vector<int32_t>& bucket,
+                     bool finales)
+{
+    bucket.assign(alfabeto, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++bucket[texto[i]];
+    }
+    int32_t suma = 0;
+    for (uint32_t c = 0; c < alfabeto; ++c) {
+        suma += bucket[c];
+        bucket[c] = finales ? suma : suma - bucket[c];
+    }
+}
+
+// Induce el orden de los sufijos L desde los que ya están en 'sa' y después
+// el de los S. El centinela va antes que todo: su vecino n - 1 (siempre L)
+// es el primero en inducirse.
+void inducir(const uint32_t* texto, size_t n, uint32_t alfabeto, const std::vector<uint8_t>& esS,
+             int32_t* sa, std::vector<int32_t>& bucket)
+{
+    calcularBuckets(texto, n, alfabeto, bucket, false);
+    sa[bucket[texto[n - 1]]++] = static_cast<int32_t>(n - 1);
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t j = sa[i] - 1;
+        if (sa[i] > 0 && !esS[static_cast<size_t>(j)]) {
+            sa[bucket[texto[j]]++] = j;
+        }
+    }
+    calcularBuckets(texto, n, alfabeto, bucket, true);
+    for (size_t i = n; i-- > 0;) {
+        const int32_t j = sa[i] - 1;
+        if (sa[i] > 0 && esS[static_cast<size_t>(j)]) {
+            sa[--bucket[texto[j]]] = j;
+        }
+    }
+}
+
+void sais(const uint32_t* texto, size_t n, uint32_t alfabeto, int32_t* sa)
+{
+    if (n == 1) {
+        sa[0] = 0;
+        return;
+    }
+    // 1. Tipos: S si el sufijo es menor que el siguiente. El último es L
+    // (el centinela es menor que todo).
+    std::vector<uint8_t> esS(n, 0);
+    for (size_t i = n - 1; i-- > 0;) {
+        esS[i] = texto[i] < texto[i + 1] || (texto[i] == texto[i + 1] && esS[i + 1]);
+    }
+    auto esLMS = [&esS](size_t i) { return i > 0 && esS[i] && !esS[i - 1]; };
+
+    // 2. Subcadenas LMS ordenadas por inducción desde los finales de bucket
+    std::vector<int32_t> bucket;
+    std::fill(sa, sa + n, kVacio);
+    calcularBuckets(texto, n, alfabeto, bucket, true);
+    for (size_t i = 1; i < n; ++i) {
+        if (esLMS(i)) {
+            sa[--bucket[texto[i]]] = static_cast<int32_t>(i);
+        }
+    }
+    inducir(texto, n, alfabeto, esS, sa, bucket);
+
+    // 3. Se juntan al principio y se numeran: dos subcadenas iguales (mismos
+    // valores y tipos hasta la siguiente LMS) tienen el mismo nombre
+    size_t n1 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (esLMS(static_cast<size_t>(sa[i]))) {
+            sa[n1++] = sa[i];
+        }
+    }
+    std::fill(sa + n1, sa + n, kVacio);
+    auto iguales = [&](size_t a, size_t b) {
+        for (size_t d = 0;; ++d) {
+            // Llegar al centinela antes que la otra: distintas
+            if (a + d == n || b + d == n) {
+                return false;
+            }
+            if (texto[a + d] != texto[b + d] || esS[a + d] != esS[b + d]) {
+                return false;
+            }
+            if (d > 0 && (esLMS(a + d) || esLMS(b + d))) {
+                return esLMS(a + d) && esLMS(b + d);
+            }
+        }
+    };
+    uint32_t nombres = 0;
+    size_t previa = n;
+    for (size_t i = 0; i < n1; ++i) {
+        const size_t p = static_cast<size_t>(sa[i]);
+        if (previa == n || !iguales(p, previa)) {
+            ++nombres;
+        }
+        previa = p;
+        // Las LMS están a distancia >= 2: p / 2 no choca entre ellas
+        sa[n1 + p / 2] = static_cast<int32_t>(nombres - 1);
+    }
+    std::vector<uint32_t> reducido;
+    reducido.reserve(n1);
+    for (size_t i = n1; i < n; ++i) {
+        if (sa[i] != kVacio) {
+            reducido.push_back(static_cast<uint32_t>(sa[i]));
+        }
+    }
+
+    // 4. Orden de las LMS: con nombres repetidos, recursión sobre el texto
+    // reducido; si no, los nombres ya lo dan
+    std::vector<int32_t> sa1(n1);
+    if (nombres < n1) {
+        sais(reducido.data(), n1, nombres, sa1.data());
+    } else {
+        for (size_t i = 0; i < n1; ++i) {
+            sa1[reducido[i]] = static_cast<int32_t>(i);
+        }
+    }
+    // Posición en el texto de cada LMS, en orden de texto
+    std::vector<int32_t> posiciones(n1);
+    size_t k = 0;
+    for (size_t i = 1; i < n; ++i) {
+        if (esLMS(i)) {
+            posiciones[k++] = static_cast<int32_t>(i);
+        }
+    }
+
+    // 5. LMS ordenadas al final de sus buckets (de atrás hacia adelante, para
+    // no pisarse) e inducción del resto
+    std::fill(sa, sa + n, kVacio);
+    calcularBuckets(texto, n, alfabeto, bucket, true);
+    for (size_t i = n1; i-- > 0;) {
+        const int32_t p = posiciones[static_cast<size_t>(sa1[i])];
+        sa[--bucket[texto[p]]] = p;
+    }
+    inducir(texto, n, alfabeto, esS, sa, bucket);
+}
+
+} // namespace
+
+void arregloSufijos(const uint32_t* texto, size_t n, uint32_t alfabeto, std::vector<int32_t>& sufijos)
+{
+    sufijos.resize(n);
+    if (n > 0) {
+        sais(texto, n, alfabeto, sufijos.data());
+    }
+}
+
+void transformarBWT(const std::vector<uint32_t>& texto, uint32_t alfabeto, uint32_t numPuntos,
+                    std::vector<uint32_t>& salida, std::vector<uint32_t>& filas)
+{
+    const size_t n = texto.size();
+    salida.resize(n);
+    filas.clear();
+    if (n == 0) {
+        return;
+    }
+    std::vector<int32_t> sufijos;
+    arregloSufijos(texto.data(), n, alfabeto, sufijos);
+    const size_t paso = formato::pasoPuntosBWT(n, numPuntos);
+    filas.resize((n + paso - 1) / paso);
+    // La fila 0 es la del centinela: termina en el último valor del texto
+    salida[0] = texto[n - 1];
+    size_t k = 1;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t p = static_cast<size_t>(sufijos[i]);
+        if (p % paso == 0) {
+            filas[p / paso] = static_cast<uint32_t>(i + 1);
+        }
+        if (p == 0) {
+            continue;
+        }
+        salida[k++] = texto[p - 1];
+    }
+}
+
+void codificarMTF(const std::vector<uint32_t>& bwt, uint32_t alfabeto, std::vector<uint32_t>& simbolos)
+{
+    simbolos.clear();
+    std::vector<uint32_t> lista(alfabeto);
+    for (uint32_t c = 0; c < alfabeto; ++c) {
+        lista[c] = c;
+    }
+    uint64_t ceros = 0;
+    auto cerrarRacha = [&]() {
+        // Base 2 biyectiva: RUNA vale 1 y RUNB 2 en cada posición
+        for (uint64_t r = ceros; r > 0; r = (r - 1) / 2) {
+            simbolos.push_back((r & 1) ? formato::kSimboloRunA : formato::kSimboloRunB);
+        }
+        ceros = 0;
+    };
+    for (uint32_t c : bwt) {
+        if (lista[0] == c) {
+            ++ceros;
+            continue;
+        }
+        cerrarRacha();
+        uint32_t v = 1;
+        while (lista[v] != c) {
+            ++v;
+        }
+        std::memmove(lista.data() + 1, lista.data(), v * sizeof(uint32_t));
+        lista[0] = c;
+        simbolos.push_back(v + 1);
+    }
+    cerrarRacha();
+}
+
+} // namespace huffman
@@ -0,0 +1,1581 @@
+#include "huffman/CompresorBloques.hpp"
+#include "huffman/HuffmanTree.hpp"
+#include "huffman/Formato.hpp"
+#include "huffman/BitWriter.hpp"
+#include "huffman/PoolHilos.hpp"
+#include "huffman/Contextos.hpp"
+#include "huffman/Rans.hpp"
+#include "huffman/Lz77.hpp"
+#include "huffman/Bwt.hpp"
+#include "lector.hpp"
+#include "histograma.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+// Celdas máximas por frame (filas * columnas). Acota la memoria de un bloque
+// cuando la matriz es muy ancha y mantiene las frecuencias dentro de un int.
+constexpr size_t kMaxCeldasBloque = size_t(1) << 26;
+
+// Lo mismo con BWT, donde el arreglo de sufijos y la inversa ocupan varias
+// veces el texto del bloque.
+constexpr size_t kMaxCeldasBWT = size_t(1) << 24;
+
+// Celdas mínimas por grupo de filas del índice. Grupos más chicos reparten
+// mejor la decodificación entre hilos pero agrandan el índice.
+constexpr size_t kCeldasPorGrupo = size_t(1) << 16;
+
+// Contextos de orden 1 distintos por frame, sin contar el de comienzo de
+// fila. Con más símbolos, los menos frecuentes comparten el último.
+constexpr size_t kMaxRanurasContexto = 255;
+
+// Codepoints con consulta directa al escribir el payload.
+constexpr uint32_t kRangoASCII = 128;
+
+struct CodigoBinario {
+    uint64_t bits;
+    int longitud;
+};
+
+// Códigos de la tabla compartida, armados una vez por archivo. Un codepoint
+// que no está en la tabla tiene longitud 0.
+struct CodigosCompartidos {
+    uint32_t id = 0;
+    uint32_t hash = 0;
+    uint64_t bytesReferencia = 0;   // lo que ocupan id y hash en el frame
+    CodigoBinario ascii[kRangoASCII] = {};
+    std::unordered_map<uint32_t, CodigoBinario> otros;
+
+    CodigoBinario codigo(uint32_t cp) const {
+        if (cp < kRangoASCII) {
+            return ascii[cp];
+        }
+        auto it = otros.find(cp);
+        return it != otros.end() ? it->second : CodigoBinario{0, 0};
+    }
+};
+
+struct FrameCodificado {
+    std::string bytes;
+    formato::FrameIndice indice;   // offset se completa al escribir
+};
+
+// Lo que todos los frames de un archivo comparten.
+struct ParametrosFrame {
+    size_t cols = 0;
+    uint32_t fondo = 0;
+    bool irregular = false;
+    bool rachasFondo = false;
+    size_t tablasContexto = 1;
+    bool rans = false;
+    bool intercalado = false;
+    int nivelLZ = 0;
+    bool bwt = false;
+    int longitudMaxima = 0;
+    const CodigosCompartidos* compartida = nullptr;
+};
+
+// Arreglos de trabajo para la tabla de un bloque. Cada hilo reutiliza los
+// suyos, así que después del primer bloque armar una tabla no reserva memoria.
+struct TrabajoTabla {
+    std::vector<HuffmanNode> nodos;
+    std::vector<uint32_t> hojas;        // codepoint de cada hoja (creciente)
+    std::vector<uint32_t> longitudHoja;
+    std::vector<uint32_t> simbolos;     // codepoints en orden canónico
+    std::vector<uint32_t> longitudes;   // longitud de código de cada uno
+    std::vector<CodigoBinario> codigos;
+};
+
+// Frecuencia de cada una de 'kClases' clases (largos de racha de fondo,
+// distancias LZ77; ver Formato.hpp). Misma interfaz de recorrido que
+// Histograma para armar su tabla.
+template <uint32_t kClases>
+struct ConteoClases {
+    uint64_t veces[kClases] = {};
+
+    template <class F>
+    void paraCada(F f) const {
+        for (uint32_t k = 0; k < kClases; ++k) {
+            if (veces[k] != 0) {
+                f(k, veces[k]);
+            }
+        }
+    }
+};
+
+using ConteoRachas = ConteoClases<formato::kClasesRacha>;
+
+// Clase de una racha: la k tal que 2^k <= largo < 2^(k+1).
+inline uint32_t claseRacha(uint64_t largo) {
+    uint32_t k = 0;
+    while (largo >> (k + 1)) {
+        ++k;
+    }
+    return k;
+}
+
+/**
+ * @brief Arma la tabla canónica de un histograma directamente sobre codepoints.
+ *
+ * Longitudes con HuffmanTree::computeCodeLengths y códigos numerados en
+ * orden (longitud, codepoint), sin pasar por cadenas ni mapas. 'conteo' es un Histograma
+ * o cualquier tipo con el mismo paraCada (p. ej. ConteoClases).
+ */
+template <class Conteo>
+void construirTablaCanonica(const Conteo& conteo, int longitudMaxima, TrabajoTabla& t)
+{
+    t.hojas.clear();
+    t.nodos.clear();
+    conteo.paraCada([&t](uint32_t cp, uint64_t f) {
+        HuffmanNode hoja;
+        hoja.frequency = f;
+        hoja.symbol = static_cast<uint32_t>(t.hojas.size());
+        t.nodos.push_back(hoja);
+        t.hojas.push_back(cp);
+    });
+    const size_t n = t.hojas.size();
+    t.simbolos.resize(n);
+    t.longitudes.resize(n);
+    t.codigos.resize(n);
+    if (n == 0) {
+        return;
+    }
+    t.nodos.resize(2 * n - 1);
+    t.longitudHoja.assign(n, 0);
+    HuffmanTree::computeCodeLengths(t.nodos.data(), n, t.longitudHoja.data(), longitudMaxima);
+
+    // Orden canónico: por longitud y, a igual longitud, por codepoint. Se
+    // reutiliza 'simbolos' para ordenar las posiciones de las hojas.
+    for (size_t i = 0; i < n; ++i) {
+        t.simbolos[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(t.simbolos.begin(), t.simbolos.end(), [&t](uint32_t a, uint32_t b) {
+        return t.longitudHoja[a] != t.longitudHoja[b] ? t.longitudHoja[a] < t.longitudHoja[b] : a < b;
+    });
+
+    uint64_t codigo = 0;
+    uint32_t longitudPrevia = 0;
+    for (size_t k = 0; k < n; ++k) {
+        const uint32_t hoja = t.simbolos[k];
+        const uint32_t longitud = t.longitudHoja[hoja];
+        codigo <<= (longitud - longitudPrevia);
+        longitudPrevia = longitud;
+        t.simbolos[k] = t.hojas[hoja];
+        t.longitudes[k] = longitud;
+        t.codigos[k] = {codigo, static_cast<int>(longitud)};
+        ++codigo;
+    }
+}
+
+// Numera los códigos de una tabla compartida igual que construirTablaCanonica
+// (sus símbolos ya vienen en orden canónico).
+void armarCodigosCompartidos(const TablaCompartida& tabla, CodigosCompartidos& c)
+{
+    c.id = tabla.id;
+    c.hash = tabla.hash;
+    std::ostringstream referencia(std::ios::binary);
+    formato::escribirVarint(referencia, tabla.id);
+    c.bytesReferencia = referencia.str().size() + 4;
+    uint64_t codigo = 0;
+    uint32_t longitudPrevia = 0;
+    for (size_t k = 0; k < tabla.simbolos.size(); ++k) {
+        const uint32_t longitud = tabla.longitudes[k];
+        codigo <<= (longitud - longitudPrevia);
+        longitudPrevia = longitud;
+        const CodigoBinario binario{codigo, static_cast<int>(longitud)};
+        if (tabla.simbolos[k] < kRangoASCII) {
+            c.ascii[tabla.simbolos[k]] = binario;
+        } else {
+            c.otros[tabla.simbolos[k]] = binario;
+        }
+        ++codigo;
+    }
+}
+
+// Bytes que ocuparían la referencia y el payload de un bloque con la tabla
+// compartida, o false si a la tabla le falta alguno de sus símbolos.
+bool costoCompartida(const CodigosCompartidos& compartida, const std::vector<uint32_t>& cps,
+                     const std::vector<uint64_t>& frecuencias, uint64_t& bytes)
+{
+    uint64_t bits = 0;
+    for (size_t s = 0; s < cps.size(); ++s) {
+        const CodigoBinario c = compartida.codigo(cps[s]);
+        if (c.longitud == 0) {
+            return false;
+        }
+        bits += frecuencias[s] * static_cast<uint64_t>(c.longitud);
+    }
+    bytes = (bits + 7) / 8 + compartida.bytesReferencia;
+    return true;
+}
+
+// Cota inferior de tabla y payload de cualquier tabla propia: ningún código
+// baja de la entropía del bloque y la tabla lleva al menos un byte por
+// símbolo, más la cantidad de símbolos, la longitud máxima y una cuenta.
+uint64_t cotaTablaPropia(const std::vector<uint64_t>& frecuencias)
+{
+    uint64_t total = 0;
+    for (uint64_t f : frecuencias) {
+        total += f;
+    }
+    double bits = 0;
+    for (uint64_t f : frecuencias) {
+        bits += static_cast<double>(f) * std::log2(static_cast<double>(total) / static_cast<double>(f));
+    }
+    return static_cast<uint64_t>(std::ceil(bits / 8)) + frecuencias.size() + 3;
+}
+
+// Bytes que ocupa el codepoint al decodificarlo a UTF-8
+inline uint64_t bytesUTF8(uint32_t cp) {
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+// Símbolo de fin de fila en modo irregular. Nunca aparece dentro de una fila.
+constexpr uint32_t kFinFila = '\n';
+
+// Recorre una fila como la ve el payload con rachas de fondo: 'literal(cp)'
+// por cada celda que no es fondo y 'racha(largo)' por cada tramo máximo de
+// fondo. Sin filas irregulares el 0 y el relleno hasta 'cols' son fondo.
+template <class Literal, class Racha>
+void recorrerFila(const uint32_t* fila, size_t ancho, const ParametrosFrame& parametros, Literal literal,
+                  Racha racha)
+{
+    size_t largo = 0;
+    for (size_t j = 0; j < ancho; ++j) {
+        const uint32_t cp = fila[j];
+        if (cp == parametros.fondo || (cp == 0 && !parametros.irregular)) {
+            ++largo;
+            continue;
+        }
+        if (largo > 0) {
+            racha(largo);
+            largo = 0;
+        }
+        literal(cp);
+    }
+    if (!parametros.irregular) {
+        largo += parametros.cols - ancho;
+    }
+    if (largo > 0) {
+        racha(largo);
+    }
+}
+
+// Un símbolo del frame al escribir el payload: su posición en orden de
+// codepoint y su código en la primera tabla (la única sin contextos).
+struct SimboloFrame {
+    uint32_t indice = 0;
+    CodigoBinario codigo{0, 0};
+};
+
+// Frecuencias de un grupo de contextos sobre los símbolos del frame ('cps',
+// en orden creciente), con el recorrido que espera construirTablaCanonica.
+struct ConteoGrupo {
+    const std::vector<uint32_t>* cps = nullptr;
+    std::vector<uint64_t> veces;
+
+    template <class F>
+    void paraCada(F f) const {
+        for (size_t s = 0; s < veces.size(); ++s) {
+            if (veces[s] != 0) {
+                f((*cps)[s], veces[s]);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Agrupa los contextos de orden 1 del bloque en pocas tablas.
+ *
+ * Cada símbolo del frame es un contexto (si hay demasiados, los menos
+ * frecuentes comparten uno), más el de comienzo de fila. Recorre el bloque
+ * igual que el payload para contar qué símbolo sigue a cuál, agrupa con
+ * agruparContextos y deja en 'tablaDe' la tabla que elige cada símbolo para
+ * el siguiente y en 'porTabla' las frecuencias de cada tabla. Devuelve
+ * cuántas tablas quedaron.
+ */
+size_t agruparTablasContexto(const BloqueTexto& bloque, const ParametrosFrame& parametros,
+                             const std::vector<uint32_t>& cps, const std::vector<uint64_t>& frecuencias,
+                             const std::unordered_map<uint32_t, SimboloFrame>& simbolos,
+                             std::vector<uint8_t>& tablaDe, uint8_t& tablaInicial,
+                             std::vector<ConteoGrupo>& porTabla)
+{
+    const size_t n = cps.size();
+
+    // 1. Ranura de contexto de cada símbolo; la última es el comienzo de fila
+    std::vector<uint32_t> ranura(n);
+    size_t numRanuras = std::min(n, kMaxRanurasContexto);
+    std::vector<uint32_t> orden(n);
+    for (uint32_t s = 0; s < n; ++s) {
+        orden[s] = s;
+    }
+    std::stable_sort(orden.begin(), orden.end(), [&frecuencias](uint32_t a, uint32_t b) {
+        return frecuencias[a] > frecuencias[b];
+    });
+    for (size_t k = 0; k < n; ++k) {
+        ranura[orden[k]] = static_cast<uint32_t>(std::min(k, numRanuras - 1));
+    }
+    const size_t inicio = numRanuras;
+
+    // 2. Qué símbolo sigue a cada contexto
+    thread_local std::vector<uint32_t> conteos;
+    conteos.assign((numRanuras + 1) * n, 0);
+    const uint32_t indiceFondo = simbolos.count(parametros.fondo) ? simbolos.at(parametros.fondo).indice : 0;
+    for (size_t i = 0; i < bloque.filas(); ++i) {
+        size_t contexto = inicio;
+        auto ver = [&](uint32_t s) {
+            ++conteos[contexto * n + s];
+            contexto = ranura[s];
+        };
+        recorrerFila(bloque.codepoints.data() + bloque.inicioFila[i], bloque.anchoFila(i), parametros,
+                     [&](uint32_t cp) { ver(simbolos.find(cp)->second.indice); },
+                     [&](size_t largo) {
+                         ver(indiceFondo);
+                         if (!parametros.rachasFondo) {
+                             conteos[contexto * n + indiceFondo] += static_cast<uint32_t>(largo - 1);
+                         }
+                     });
+        if (parametros.irregular) {
+            ver(simbolos.find(kFinFila)->second.indice);
+        }
+    }
+
+    // 3. Grupos de contextos y las frecuencias de cada uno
+    const std::vector<uint8_t> grupo =
+        agruparContextos(conteos, numRanuras + 1, n, parametros.tablasContexto);
+    size_t numTablas = 1;
+    for (uint8_t g : grupo) {
+        numTablas = std::max<size_t>(numTablas, size_t(g) + 1);
+    }
+    tablaInicial = grupo[inicio];
+    tablaDe.resize(n);
+    for (size_t s = 0; s < n; ++s) {
+        tablaDe[s] = grupo[ranura[s]];
+    }
+
+    porTabla.resize(numTablas);
+    for (auto& t : porTabla) {
+        t.cps = &cps;
+        t.veces.assign(n, 0);
+    }
+    for (size_t c = 0; c <= numRanuras; ++c) {
+        ConteoGrupo& t = porTabla[grupo[c]];
+        const uint32_t* fila = conteos.data() + c * n;
+        for (size_t s = 0; s < n; ++s) {
+            t.veces[s] += fila[s];
+        }
+    }
+    return numTablas;
+}
+
+// Tabla rANS de un frame: los símbolos presentes en orden de codepoint, sus
+// frecuencias normalizadas y la operación que codifica a cada uno.
+struct TablaRANS {
+    int bitsEscala = 0;
+    std::vector<uint32_t> indices;      // posición de cada símbolo en las frecuencias de entrada
+    std::vector<uint32_t> simbolos;     // codepoints (o clases de racha)
+    std::vector<uint32_t> frecuencias;
+    std::vector<OperacionRANS> operaciones;
+};
+
+// 'veces' va por posición; 'cps' da el símbolo de cada posición (sin 'cps',
+// la posición misma, como en las clases de racha).
+void construirTablaRANS(const std::vector<uint64_t>& veces, TablaRANS& tabla,
+                        const std::vector<uint32_t>* cps = nullptr)
+{
+    size_t presentes = 0;
+    for (uint64_t v : veces) {
+        presentes += v != 0;
+    }
+    if (presentes == 0) {
+        return;
+    }
+    tabla.bitsEscala = bitsEscalaRANS(presentes);
+    std::vector<uint32_t> normalizadas;
+    normalizarFrecuencias(veces, tabla.bitsEscala, normalizadas);
+    uint32_t inicio = 0;
+    for (size_t s = 0; s < veces.size(); ++s) {
+        if (normalizadas[s] == 0) {
+            continue;
+        }
+        tabla.indices.push_back(static_cast<uint32_t>(s));
+        tabla.simbolos.push_back(cps != nullptr ? (*cps)[s] : static_cast<uint32_t>(s));
+        tabla.frecuencias.push_back(normalizadas[s]);
+        tabla.operaciones.push_back(operacionRANS(inicio, normalizadas[s], static_cast<uint32_t>(tabla.bitsEscala)));
+        inicio += normalizadas[s];
+    }
+}
+
+// Destinos del payload para escribirPayload. Con códigos Huffman los bits van
+// directo al BitWriter y un grupo del índice empieza en cualquier bit.
+class PayloadHuffman {
+public:
+    PayloadHuffman(std::ostream& out, const std::vector<CodigoBinario>& codigos, size_t numTablas,
+                   const CodigoBinario* codigoRacha)
+        : bits_(out), codigos_(codigos), numTablas_(numTablas), codigoRacha_(codigoRacha) {}
+
+    // Sin contextos el código va en el propio símbolo: una consulta menos.
+    template <bool kContextos>
+    void simbolo(const SimboloFrame& s, uint8_t tabla) {
+        const CodigoBinario& c = kContextos ? codigos_[s.indice * numTablas_ + tabla] : s.codigo;
+        bits_.write(c.bits, c.longitud);
+    }
+    template <bool kContextos>
+    void repetir(const SimboloFrame& s, uint8_t tabla, size_t veces) {
+        const CodigoBinario c = kContextos ? codigos_[s.indice * numTablas_ + tabla] : s.codigo;
+        for (size_t j = 0; j < veces; ++j) {
+            bits_.write(c.bits, c.longitud);
+        }
+    }
+    void claseRacha(uint32_t k) { bits_.write(codigoRacha_[k].bits, codigoRacha_[k].longitud); }
+    void bitsExtra(uint64_t valor, int n) { bits_.write(valor, n); }
+    // Dónde empieza un grupo nuevo, en bits desde el inicio del payload.
+    uint64_t abrirGrupo() { return bits_.bitsEscritos(); }
+    void terminar() { bits_.flush(); }
+
+private:
+    BitWriter bits_;
+    const std::vector<CodigoBinario>& codigos_;
+    size_t numTablas_;
+    const CodigoBinario* codigoRacha_;
+};
+
+// Con streams intercalados cada código va al stream que le toca por turno
+// (la clase de una racha junto con sus bits extra). Los streams se arman
+// enteros en memoria y al terminar se escriben por grupo, uno tras otro.
+class PayloadIntercalado {
+public:
+    static constexpr uint32_t kStreams = formato::kStreamsIntercalados;
+
+    PayloadIntercalado(std::ostream& out, const std::vector<CodigoBinario>& codigos, size_t numTablas,
+                       const CodigoBinario* codigoRacha)
+        : out_(out),
+          bits_{BitWriter(streams_[0], kCapacidad), BitWriter(streams_[1], kCapacidad),
+                BitWriter(streams_[2], kCapacidad), BitWriter(streams_[3], kCapacidad)},
+          codigos_(codigos), numTablas_(numTablas), codigoRacha_(codigoRacha) {
+        static_assert(kStreams == 4, "un BitWriter por stream");
+    }
+
+    template <bool kContextos>
+    void simbolo(const SimboloFrame& s, uint8_t tabla) {
+        const CodigoBinario& c = kContextos ? codigos_[s.indice * numTablas_ + tabla] : s.codigo;
+        escribir(c);
+    }
+    template <bool kContextos>
+    void repetir(const SimboloFrame& s, uint8_t tabla, size_t veces) {
+        const CodigoBinario c = kContextos ? codigos_[s.indice * numTablas_ + tabla] : s.codigo;
+        for (size_t j = 0; j < veces; ++j) {
+            escribir(c);
+        }
+    }
+    void claseRacha(uint32_t k) {
+        ultimo_ = turno_;
+        escribir(codigoRacha_[k]);
+    }
+    void bitsExtra(uint64_t valor, int n) { bits_[ultimo_].write(valor, n); }
+    // Cada grupo empieza en el stream 0 y en un byte entero.
+    uint64_t abrirGrupo() {
+        cerrarGrupo();
+        abierto_ = true;
+        turno_ = 0;
+        return bytesEscritos_ * 8;
+    }
+    void terminar() {
+        cerrarGrupo();
+        std::string streams[kStreams];
+        for (uint32_t k = 0; k < kStreams; ++k) {
+            streams[k] = streams_[k].str();
+        }
+        uint64_t desde[kStreams] = {};
+        for (size_t i = 0; i < bytesPorStream_.size(); ++i) {
+            const uint32_t k = static_cast<uint32_t>(i % kStreams);
+            out_.write(streams[k].data() + desde[k], static_cast<std::streamsize>(bytesPorStream_[i]));
+            desde[k] += bytesPorStream_[i];
+        }
+    }
+    // Bytes de cada stream de cada grupo, kStreams por grupo.
+    const std::vector<uint64_t>& bytesPorStream() const { return bytesPorStream_; }
+
+private:
+    // Buffer de cada BitWriter: los streams terminan en memoria de todos modos.
+    static constexpr size_t kCapacidad = size_t(1) << 16;
+
+    void escribir(const CodigoBinario& c) {
+        bits_[turno_].write(c.bits, c.longitud);
+        turno_ = (turno_ + 1) % kStreams;
+    }
+
+    void cerrarGrupo() {
+        if (!abierto_) {
+            return;
+        }
+        for (uint32_t k = 0; k < kStreams; ++k) {
+            bits_[k].flush();
+            const uint64_t total = bits_[k].bitsEscritos() / 8;
+            bytesPorStream_.push_back(total - escritosStream_[k]);
+            bytesEscritos_ += total - escritosStream_[k];
+            escritosStream_[k] = total;
+        }
+        abierto_ = false;
+    }
+
+    std::ostream& out_;
+    std::ostringstream streams_[kStreams];
+    BitWriter bits_[kStreams];
+    const std::vector<CodigoBinario>& codigos_;
+    size_t numTablas_;
+    const CodigoBinario* codigoRacha_;
+    uint32_t turno_ = 0;
+    uint32_t ultimo_ = 0;
+    uint64_t escritosStream_[kStreams] = {};
+    std::vector<uint64_t> bytesPorStream_;
+    uint64_t bytesEscritos_ = 0;
+    bool abierto_ = false;
+};
+
+// Con rANS cada grupo es un stream propio: sus operaciones se juntan y se
+// codifican al revés cuando empieza el grupo siguiente o termina el frame.
+class PayloadRANS {
+public:
+    PayloadRANS(std::ostream& out, const std::vector<OperacionRANS>& operaciones, size_t numTablas,
+                const OperacionRANS* opRacha)
+        : out_(out), operaciones_(operaciones), numTablas_(numTablas), opRacha_(opRacha) {}
+
+    template <bool kContextos>
+    void simbolo(const SimboloFrame& s, uint8_t tabla) {
+        pendientes_.push_back(operaciones_[s.indice * numTablas_ + (kContextos ? tabla : 0)]);
+    }
+    template <bool kContextos>
+    void repetir(const SimboloFrame& s, uint8_t tabla, size_t veces) {
+        pendientes_.insert(pendientes_.end(), veces, operaciones_[s.indice * numTablas_ + (kContextos ? tabla : 0)]);
+    }
+    void claseRacha(uint32_t k) { pendientes_.push_back(opRacha_[k]); }
+    // Bits extra en tramos de hasta kBitsCrudosRANS, del más alto al más bajo.
+    void bitsExtra(uint64_t valor, int n) {
+        while (n > 0) {
+            const int tramo = std::min<int>(n, static_cast<int>(formato::kBitsCrudosRANS));
+            n -= tramo;
+            const uint32_t bits = static_cast<uint32_t>((valor >> n) & ((uint64_t(1) << tramo) - 1));
+            pendientes_.push_back(operacionRANS(bits, 1, static_cast<uint32_t>(tramo)));
+        }
+    }
+    uint64_t abrirGrupo() {
+        cerrarGrupo();
+        abierto_ = true;
+        return bytesEscritos_ * 8;
+    }
+    void terminar() { cerrarGrupo(); }
+    const std::vector<uint64_t>& bytesPorGrupo() const { return bytesPorGrupo_; }
+
+private:
+    void cerrarGrupo() {
+        if (!abierto_) {
+            return;
+        }
+        stream_.clear();
+        codificarRANS(pendientes_, stream_);
+        out_.write(reinterpret_cast<const char*>(stream_.data()), static_cast<std::streamsize>(stream_.size()));
+        bytesEscritos_ += stream_.size();
+        bytesPorGrupo_.push_back(stream_.size());
+        pendientes_.clear();
+        abierto_ = false;
+    }
+
+    std::ostream& out_;
+    const std::vector<OperacionRANS>& operaciones_;
+    size_t numTablas_;
+    const OperacionRANS* opRacha_;
+    std::vector<OperacionRANS> pendientes_;
+    std::vector<unsigned char> stream_;
+    std::vector<uint64_t> bytesPorGrupo_;
+    uint64_t bytesEscritos_ = 0;
+    bool abierto_ = false;
+};
+
+// Recorre las filas del bloque como las lee el decoder y las manda a
+// 'salida' (PayloadHuffman, PayloadIntercalado o PayloadRANS), partidas en grupos para el índice.
+// Cada fila empieza con la tabla inicial: los grupos del índice se pueden
+// decodificar sin conocer la fila anterior.
+template <bool kContextos, class Payload>
+void escribirFilas(const BloqueTexto& bloque, const ParametrosFrame& parametros,
+                   const std::unordered_map<uint32_t, SimboloFrame>& simbolos, uint8_t tablaInicial,
+                   const std::vector<uint8_t>& tablaDe, Payload& salida,
+                   std::vector<formato::GrupoIndice>& grupos)
+{
+    const bool irregular = parametros.irregular;
+    auto itFondo = simbolos.find(parametros.fondo);
+    const SimboloFrame* simboloFondo = itFondo != simbolos.end() ? &itFondo->second : nullptr;
+    const SimboloFrame* finFila = irregular ? &simbolos.find(kFinFila)->second : nullptr;
+    const uint64_t bytesFondo = bytesUTF8(parametros.fondo);
+    // Acceso directo para ASCII, que es casi todo el texto; el resto
+    // pasa por el mapa
+    const SimboloFrame* ascii[kRangoASCII] = {};
+    for (auto& par : simbolos) {
+        if (par.first < kRangoASCII) {
+            ascii[par.first] = &par.second;
+        }
+    }
+    for (size_t i = 0; i < bloque.filas(); ++i) {
+        if (grupos.empty() || grupos.back().simbolos >= kCeldasPorGrupo) {
+            formato::GrupoIndice grupo;
+            grupo.filaInicial = i;
+            grupo.bitInicial = salida.abrirGrupo();
+            grupos.push_back(grupo);
+        }
+        formato::GrupoIndice& grupo = grupos.back();
+
+        uint8_t tabla = tablaInicial;
+        auto escribir = [&](const SimboloFrame& s) {
+            salida.template simbolo<kContextos>(s, tabla);
+            if (kContextos) {
+                tabla = tablaDe[s.indice];
+            }
+        };
+        const size_t ancho = bloque.anchoFila(i);
+        recorrerFila(bloque.codepoints.data() + bloque.inicioFila[i], ancho, parametros, [&](uint32_t cp) {
+            escribir(cp < kRangoASCII ? *ascii[cp] : simbolos.find(cp)->second);
+            grupo.bytesSalida += bytesUTF8(cp);
+        }, [&](size_t largo) {
+            grupo.bytesSalida += largo * bytesFondo;
+            escribir(*simboloFondo);
+            if (!parametros.rachasFondo) {
+                // Tras el primero la tabla ya no cambia: mismo código
+                salida.template repetir<kContextos>(*simboloFondo, tabla, largo - 1);
+                return;
+            }
+            const uint32_t k = claseRacha(largo);
+            salida.claseRacha(k);
+            if (k > 0) {
+                salida.bitsExtra(largo - (uint64_t(1) << k), static_cast<int>(k));
+            }
+        });
+        if (irregular) {
+            escribir(*finFila);
+        }
+        grupo.simbolos += irregular ? ancho + 1 : parametros.cols;
+    }
+}
+
+// Escribe el payload completo del bloque en 'salida'. Con una sola tabla no
+// hay que seguir la tabla actual: se especializa para que ese caso quede con
+// una sola consulta por celda.
+template <class Payload>
+void escribirPayload(const BloqueTexto& bloque, const ParametrosFrame& parametros, const std::vector<uint32_t>& cps,
+                     const std::unordered_map<uint32_t, SimboloFrame>& simbolos, uint8_t tablaInicial,
+                     const std::vector<uint8_t>& tablaDe, size_t numTablas, Payload& salida,
+                     std::vector<formato::GrupoIndice>& grupos)
+{
+    if (cps.empty()) {
+        return;
+    }
+    if (numTablas > 1) {
+        escribirFilas<true>(bloque, parametros, simbolos, tablaInicial, tablaDe, salida, grupos);
+    } else {
+        escribirFilas<false>(bloque, parametros, simbolos, tablaInicial, tablaDe, salida, grupos);
+    }
+    salida.terminar();
+}
+
+// Recorre el texto de las filas [desde, hasta) como lo escribe el decoder:
+// 'f(cp)' por cada codepoint, con '\n' entre filas y, sin filas irregulares,
+// el 0 y el relleno hasta 'cols' como fondo.
+template <class F>
+void recorrerTexto(const BloqueTexto& bloque, size_t desde, size_t hasta, const ParametrosFrame& parametros, F f)
+{
+    for (size_t i = desde; i < hasta; ++i) {
+        if (i > desde) {
+            f(uint32_t('\n'));
+        }
+        const uint32_t* fila = bloque.codepoints.data() + bloque.inicioFila[i];
+        const size_t ancho = bloque.anchoFila(i);
+        for (size_t j = 0; j < ancho; ++j) {
+            f(fila[j] == 0 && !parametros.irregular ? parametros.fondo : fila[j]);
+        }
+        if (!parametros.irregular) {
+            for (size_t j = ancho; j < parametros.cols; ++j) {
+                f(parametros.fondo);
+            }
+        }
+    }
+}
+
+// Suma las celdas y los bytes de salida de la fila 'i' a 'grupo'.
+void contarFila(const BloqueTexto& bloque, size_t i, const ParametrosFrame& parametros, formato::GrupoIndice& grupo)
+{
+    const uint32_t* fila = bloque.codepoints.data() + bloque.inicioFila[i];
+    const size_t ancho = bloque.anchoFila(i);
+    for (size_t j = 0; j < ancho; ++j) {
+        grupo.bytesSalida += bytesUTF8(fila[j] == 0 && !parametros.irregular ? parametros.fondo : fila[j]);
+    }
+    if (parametros.irregular) {
+        grupo.simbolos += ancho + 1;
+    } else {
+        grupo.bytesSalida += (parametros.cols - ancho) * bytesUTF8(parametros.fondo);
+        grupo.simbolos += parametros.cols;
+    }
+}
+
+/**
+ * @brief Codifica un bloque como frame kFrameLZ (ver Formato.hpp).
+ *
+ * Parte el bloque en los mismos grupos de filas que codificarFrame, pasa el
+ * texto de cada grupo por BuscadorLZ y codifica los tokens con dos tablas
+ * canónicas: literales más clases de largo, y clases de distancia. Los
+ * tokens de todo el bloque quedan en memoria porque las tablas salen de sus
+ * frecuencias.
+ */
+FrameCodificado codificarFrameLZ(const BloqueTexto& bloque, const ParametrosFrame& parametros)
+{
+    FrameCodificado resultado;
+    resultado.indice.filas = bloque.filas();
+    auto& grupos = resultado.indice.grupos;
+
+    // 1. Grupos de filas y el parseo de cada uno
+    BuscadorLZ buscador(parametros.nivelLZ);
+    std::vector<TokenLZ> tokens;
+    std::vector<size_t> primerToken;
+    std::vector<uint64_t> bytesTexto;
+    std::string texto;
+    const bool vacio = !parametros.irregular && parametros.cols == 0;
+    for (size_t i = 0; i < bloque.filas() && !vacio;) {
+        formato::GrupoIndice grupo;
+        grupo.filaInicial = i;
+        for (; i < bloque.filas() && grupo.simbolos < kCeldasPorGrupo; ++i) {
+            contarFila(bloque, i, parametros, grupo);
+        }
+        texto.clear();
+        recorrerTexto(bloque, grupo.filaInicial, i, parametros, [&texto](uint32_t cp) { text::push_utf8(texto, cp); });
+        primerToken.push_back(tokens.size());
+        bytesTexto.push_back(texto.size());
+        buscador.parsear(reinterpret_cast<const unsigned char*>(texto.data()), texto.size(), tokens);
+        grupos.push_back(grupo);
+    }
+    primerToken.push_back(tokens.size());
+
+    // 2. Frecuencias: literales y clases de largo en una tabla, distancias en otra
+    thread_local Histograma conteo;
+    conteo.clear();
+    ConteoClases<formato::kClasesLargoLZ> conteoLargos;
+    ConteoClases<formato::kClasesDistanciaLZ> conteoDistancias;
+    for (const TokenLZ& t : tokens) {
+        if (t.largo == 0) {
+            conteo.sumar(t.valor);
+        } else {
+            ++conteoLargos.veces[formato::claseLZ(t.largo - formato::kMinLargoLZ)];
+            ++conteoDistancias.veces[formato::claseLZ(t.valor - 1)];
+        }
+    }
+    conteoLargos.paraCada([](uint32_t k, uint64_t f) { conteo.sumar(formato::kSimboloLargoLZ + k, f); });
+
+    // 3. Tablas canónicas y el código de cada símbolo
+    thread_local TrabajoTabla trabajoLiterales;
+    thread_local TrabajoTabla trabajoDistancias;
+    construirTablaCanonica(conteo, parametros.longitudMaxima, trabajoLiterales);
+    construirTablaCanonica(conteoDistancias, parametros.longitudMaxima, trabajoDistancias);
+    CodigoBinario ascii[kRangoASCII] = {};
+    CodigoBinario codigoLargo[formato::kClasesLargoLZ] = {};
+    CodigoBinario codigoDistancia[formato::kClasesDistanciaLZ] = {};
+    std::unordered_map<uint32_t, CodigoBinario> otros;
+    for (size_t k = 0; k < trabajoLiterales.simbolos.size(); ++k) {
+        const uint32_t s = trabajoLiterales.simbolos[k];
+        if (s < kRangoASCII) {
+            ascii[s] = trabajoLiterales.codigos[k];
+        } else if (s >= formato::kSimboloLargoLZ) {
+            codigoLargo[s - formato::kSimboloLargoLZ] = trabajoLiterales.codigos[k];
+        } else {
+            otros[s] = trabajoLiterales.codigos[k];
+        }
+    }
+    for (size_t k = 0; k < trabajoDistancias.simbolos.size(); ++k) {
+        codigoDistancia[trabajoDistancias.simbolos[k]] = trabajoDistancias.codigos[k];
+    }
+
+    // 4. Payload: un solo stream de bits; cada grupo empieza donde terminó
+    // el anterior
+    std::ostringstream payload(std::ios::binary);
+    {
+        BitWriter bits(payload);
+        auto escribir = [&bits](const CodigoBinario& c) { bits.write(c.bits, c.longitud); };
+        auto extra = [&bits](uint32_t valor, uint32_t clase) {
+            const uint32_t n = formato::bitsExtraLZ(clase);
+            if (n > 0) {
+                bits.write(valor - formato::baseLZ(clase), static_cast<int>(n));
+            }
+        };
+        for (size_t g = 0; g < grupos.size(); ++g) {
+            grupos[g].bitInicial = bits.bitsEscritos();
+            for (size_t k = primerToken[g]; k < primerToken[g + 1]; ++k) {
+                const TokenLZ& t = tokens[k];
+                if (t.largo == 0) {
+                    escribir(t.valor < kRangoASCII ? ascii[t.valor] : otros.find(t.valor)->second);
+                    continue;
+                }
+                const uint32_t largo = t.largo - formato::kMinLargoLZ;
+                const uint32_t claseLargo = formato::claseLZ(largo);
+                escribir(codigoLargo[claseLargo]);
+                extra(largo, claseLargo);
+                const uint32_t distancia = t.valor - 1;
+                const uint32_t claseDistancia = formato::claseLZ(distancia);
+                escribir(codigoDistancia[claseDistancia]);
+                extra(distancia, claseDistancia);
+            }
+        }
+        bits.flush();
+    }
+    const std::string bytes = payload.str();
+
+    // 5. Frame: tipo | filas | tablas | grupos | tamaño del payload | payload
+    std::ostringstream out(std::ios::binary);
+    out.put(static_cast<char>(formato::kFrameLZ));
+    formato::escribirVarint(out, bloque.filas());
+    formato::escribirTablaCanonica(out, trabajoLiterales.simbolos, trabajoLiterales.longitudes);
+    formato::escribirTablaCanonica(out, trabajoDistancias.simbolos, trabajoDistancias.longitudes);
+    formato::escribirVarint(out, grupos.size());
+    for (size_t g = 0; g < grupos.size(); ++g) {
+        const uint64_t filaFinal = g + 1 < grupos.size() ? grupos[g + 1].filaInicial : bloque.filas();
+        formato::escribirVarint(out, filaFinal - grupos[g].filaInicial);
+        formato::escribirVarint(out, bytesTexto[g]);
+    }
+    formato::escribirVarint(out, bytes.size());
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    resultado.bytes = out.str();
+    return resultado;
+}
+
+/**
+ * @brief Codifica un bloque como frame kFrameBWT (ver Formato.hpp).
+ *
+ * Todo el bloque es un grupo del índice: la transformada necesita el texto
+ * entero para invertirse, así que los hilos del decoder se reparten por
+ * bloque. El texto pasa a índices en el alfabeto del bloque, por
+ * transformarBWT y codificarMTF, y los símbolos resultantes van con una
+ * tabla canónica.
+ */
+FrameCodificado codificarFrameBWT(const BloqueTexto& bloque, const ParametrosFrame& parametros)
+{
+    FrameCodificado resultado;
+    resultado.indice.filas = bloque.filas();
+
+    // 1. Texto del bloque y su alfabeto en orden de codepoint
+    std::vector<uint32_t> texto;
+    thread_local Histograma conteo;
+    conteo.clear();
+    const bool vacio = !parametros.irregular && parametros.cols == 0;
+    if (bloque.filas() > 0 && !vacio) {
+        formato::GrupoIndice grupo;
+        for (size_t i = 0; i < bloque.filas(); ++i) {
+            contarFila(bloque, i, parametros, grupo);
+        }
+        resultado.indice.grupos.push_back(grupo);
+        texto.reserve(grupo.simbolos);
+        recorrerTexto(bloque, 0, bloque.filas(), parametros, [&texto](uint32_t cp) { texto.push_back(cp); });
+        conteo.contar(texto);
+    }
+    std::vector<uint32_t> alfabeto;
+    conteo.paraCada([&alfabeto](uint32_t cp, uint64_t) { alfabeto.push_back(cp); });
+    // Índice de cada codepoint en el alfabeto: un arreglo por hilo que cubre
+    // todo Unicode, solo se escriben las entradas del bloque
+    thread_local std::vector<uint32_t> indiceDe(0x110000);
+    for (uint32_t k = 0; k < alfabeto.size(); ++k) {
+        indiceDe[alfabeto[k]] = k;
+    }
+    for (uint32_t& cp : texto) {
+        cp = indiceDe[cp];
+    }
+
+    // 2. Transformada, move-to-front y rachas
+    const uint32_t numAlfabeto = static_cast<uint32_t>(alfabeto.size());
+    std::vector<uint32_t> bwt;
+    const uint64_t largo = texto.size();
+    std::vector<uint32_t> puntos;
+    transformarBWT(texto, numAlfabeto, formato::kPuntosBWT, bwt, puntos);
+    std::vector<uint32_t>().swap(texto);
+    std::vector<uint32_t> simbolos;
+    codificarMTF(bwt, numAlfabeto, simbolos);
+    std::vector<uint32_t>().swap(bwt);
+
+    // 3. Tabla canónica de los símbolos MTF (a lo sumo alfabeto + 1)
+    ConteoGrupo conteoMTF;
+    std::vector<uint32_t> identidad(numAlfabeto + 1);
+    for (uint32_t s = 0; s <= numAlfabeto; ++s) {
+        identidad[s] = s;
+    }
+    conteoMTF.cps = &identidad;
+    conteoMTF.veces.assign(numAlfabeto + 1, 0);
+    for (uint32_t s : simbolos) {
+        ++conteoMTF.veces[s];
+    }
+    thread_local TrabajoTabla trabajo;
+    construirTablaCanonica(conteoMTF, parametros.longitudMaxima, trabajo);
+    std::vector<CodigoBinario> codigos(numAlfabeto + 1, CodigoBinario{0, 0});
+    for (size_t k = 0; k < trabajo.simbolos.size(); ++k) {
+        codigos[trabajo.simbolos[k]] = trabajo.codigos[k];
+    }
+
+    // 4. Payload
+    std::ostringstream payload(std::ios::binary);
+    {
+        BitWriter bits(payload);
+        for (uint32_t s : simbolos) {
+            bits.write(codigos[s].bits, codigos[s].longitud);
+        }
+        bits.flush();
+    }
+    const std::string bytes = payload.str();
+
+    // 5. Frame: tipo | filas | alfabeto | tabla | largo | puntos | tamaño del
+    // payload | payload
+    std::ostringstream out(std::ios::binary);
+    out.put(static_cast<char>(formato::kFrameBWT));
+    formato::escribirVarint(out, bloque.filas());
+    formato::escribirVarint(out, alfabeto.size());
+    for (size_t k = 0; k < alfabeto.size(); ++k) {
+        formato::escribirVarint(out, k == 0 ? alfabeto[0] : alfabeto[k] - alfabeto[k - 1]);
+    }
+    formato::escribirTablaCanonica(out, trabajo.simbolos, trabajo.longitudes);
+    formato::escribirVarint(out, largo);
+    formato::escribirVarint(out, puntos.size());
+    for (uint32_t fila : puntos) {
+        formato::escribirVarint(out, fila);
+    }
+    formato::escribirVarint(out, bytes.size());
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    resultado.bytes = out.str();
+    return resultado;
+}
+
+/**
+ * @brief Codifica un bloque de filas como frame independiente (ver Formato.hpp).
+ *
+ * Las celdas más allá del ancho de cada fila, y los codepoints 0, se codifican
+ * como fondo, igual que en la matriz dispersa original. En modo irregular no
+ * hay relleno: cada fila va tal cual y termina con kFinFila. Con rachas de
+ * fondo cada tramo de fondo va como una sola racha, y con tablas de contexto
+ * cada símbolo usa la tabla que eligió el anterior. Con rANS las tablas
+ * guardan frecuencias y el payload son streams rANS en lugar de códigos; con
+ * streams intercalados los códigos de cada grupo se reparten por turno. Con
+ * nivel LZ77 el frame es un kFrameLZ (codificarFrameLZ) y con BWT un
+ * kFrameBWT (codificarFrameBWT). Con tabla compartida el frame es un
+ * kFrameCompartido cuando esa tabla tiene todos los símbolos del bloque y
+ * lo deja más chico que una propia. No toca estado compartido, así que varios
+ * bloques pueden codificarse a la vez.
+ */
+FrameCodificado codificarFrame(const BloqueTexto& bloque, const ParametrosFrame& parametros)
+{
+    if (parametros.bwt) {
+        return codificarFrameBWT(bloque, parametros);
+    }
+    if (parametros.nivelLZ > 0) {
+        return codificarFrameLZ(bloque, parametros);
+    }
+    const size_t cols = parametros.cols;
+    const uint32_t fondo = parametros.fondo;
+    const bool irregular = parametros.irregular;
+
+    FrameCodificado resultado;
+    resultado.indice.filas = bloque.filas();
+
+    // 1. Frecuencias de las celdas del bloque (incluido el relleno de fondo,
+    // o los fines de fila en modo irregular). El histograma es uno por hilo:
+    // clear() solo limpia lo que contó el bloque anterior
+    thread_local Histograma conteo;
+    conteo.clear();
+    conteo.contar(bloque.codepoints);
+    if (irregular) {
+        conteo.sumar(kFinFila, bloque.filas());
+    } else {
+        const uint64_t celdasFondo = static_cast<uint64_t>(bloque.filas()) * cols
+            - bloque.codepoints.size() + conteo.frecuencia(0) + conteo.frecuencia(fondo);
+        conteo.quitar(0);
+        conteo.quitar(fondo);
+        conteo.sumar(fondo, celdasFondo);
+    }
+    // Con rachas el fondo aparece una vez por tramo, y aparte cada clase de largo
+    ConteoRachas conteoRachas;
+    if (parametros.rachasFondo) {
+        uint64_t rachas = 0;
+        for (size_t i = 0; i < bloque.filas(); ++i) {
+            recorrerFila(bloque.codepoints.data() + bloque.inicioFila[i], bloque.anchoFila(i), parametros,
+                         [](uint32_t) {}, [&](size_t largo) {
+                             ++conteoRachas.veces[claseRacha(largo)];
+                             ++rachas;
+                         });
+        }
+        conteo.quitar(fondo);
+        conteo.sumar(fondo, rachas);
+    }
+
+    // 2. Símbolos del frame en orden de codepoint
+    std::vector<uint32_t> cps;
+    std::vector<uint64_t> frecuencias;
+    conteo.paraCada([&](uint32_t cp, uint64_t f) {
+        cps.push_back(cp);
+        frecuencias.push_back(f);
+    });
+    std::unordered_map<uint32_t, SimboloFrame> simbolos;
+    simbolos.reserve(cps.size());
+    for (size_t s = 0; s < cps.size(); ++s) {
+        simbolos[cps[s]].indice = static_cast<uint32_t>(s);
+    }
+
+    // 3. Frecuencias de cada tabla del bloque: una, o una por grupo de
+    // contextos
+    std::vector<ConteoGrupo> porTabla;
+    std::vector<uint8_t> tablaDe;
+    uint8_t tablaInicial = 0;
+    size_t numTablas = 1;
+    if (parametros.tablasContexto > 1 && cps.size() > 1) {
+        numTablas = agruparTablasContexto(bloque, parametros, cps, frecuencias, simbolos, tablaDe,
+                                          tablaInicial, porTabla);
+    } else {
+        porTabla.resize(1);
+        porTabla[0].cps = &cps;
+        porTabla[0].veces = frecuencias;
+        tablaDe.assign(cps.size(), 0);
+    }
+
+    // 4. Payload en memoria: hace falta su tamaño antes de escribirlo. De paso
+    // se parte en grupos de filas para el índice.
+    std::ostringstream payload(std::ios::binary);
+    std::ostringstream tablas(std::ios::binary);
+    std::vector<uint64_t> bytesGrupo;
+    bool compartida = false;
+    if (parametros.rans) {
+        std::vector<TablaRANS> tablasRANS(numTablas);
+        std::vector<OperacionRANS> operaciones(cps.size() * numTablas);
+        for (size_t t = 0; t < numTablas; ++t) {
+            construirTablaRANS(porTabla[t].veces, tablasRANS[t], &cps);
+            const TablaRANS& tabla = tablasRANS[t];
+            for (size_t k = 0; k < tabla.indices.size(); ++k) {
+                operaciones[tabla.indices[k] * numTablas + t] = tabla.operaciones[k];
+            }
+            formato::escribirTablaRANS(tablas, tabla.simbolos, tabla.frecuencias, tabla.bitsEscala);
+        }
+        TablaRANS rachas;
+        if (parametros.rachasFondo) {
+            construirTablaRANS(std::vector<uint64_t>(conteoRachas.veces, conteoRachas.veces + formato::kClasesRacha),
+                               rachas);
+            formato::escribirTablaRANS(tablas, rachas.simbolos, rachas.frecuencias, rachas.bitsEscala);
+        }
+        OperacionRANS opRacha[formato::kClasesRacha] = {};
+        for (size_t k = 0; k < rachas.indices.size(); ++k) {
+            opRacha[rachas.indices[k]] = rachas.operaciones[k];
+        }
+        PayloadRANS salida(payload, operaciones, numTablas, opRacha);
+        escribirPayload(bloque, parametros, cps, simbolos, tablaInicial, tablaDe, numTablas, salida,
+                        resultado.indice.grupos);
+        bytesGrupo = salida.bytesPorGrupo();
+    } else {
+        // Tablas canónicas y el código de cada símbolo en cada tabla:
+        // codigos[simbolo * numTablas + tabla]
+        thread_local std::vector<TrabajoTabla> trabajos(formato::kMaxTablasContexto);
+        std::vector<CodigoBinario> codigos(cps.size() * numTablas, CodigoBinario{0, 0});
+        // Con tabla compartida (siempre una sola tabla) se usa la que deje el
+        // frame más chico. Si la compartida ya le gana a la cota de cualquier
+        // tabla propia, la propia ni se arma.
+        uint64_t bytesCompartida = 0;
+        const bool cubre = parametros.compartida != nullptr && !cps.empty() &&
+                           costoCompartida(*parametros.compartida, cps, frecuencias, bytesCompartida);
+        compartida = cubre && bytesCompartida <= cotaTablaPropia(frecuencias);
+        for (size_t t = 0; t < numTablas && !compartida; ++t) {
+            TrabajoTabla& trabajo = trabajos[t];
+            construirTablaCanonica(porTabla[t], parametros.longitudMaxima, trabajo);
+            for (size_t k = 0; k < trabajo.simbolos.size(); ++k) {
+                SimboloFrame& simbolo = simbolos.find(trabajo.simbolos[k])->second;
+                codigos[simbolo.indice * numTablas + t] = trabajo.codigos[k];
+                if (t == 0) {
+                    simbolo.codigo = trabajo.codigos[k];
+                }
+            }
+            formato::escribirTablaCanonica(tablas, trabajo.simbolos, trabajo.longitudes);
+        }
+        if (cubre && !compartida) {
+            uint64_t bits = 0;
+            for (size_t s = 0; s < cps.size(); ++s) {
+                bits += frecuencias[s] * static_cast<uint64_t>(codigos[s].longitud);
+            }
+            compartida = bytesCompartida < static_cast<uint64_t>(tablas.tellp()) + (bits + 7) / 8;
+        }
+        if (compartida) {
+            tablas.str("");
+            for (size_t s = 0; s < cps.size(); ++s) {
+                codigos[s] = simbolos.find(cps[s])->second.codigo = parametros.compartida->codigo(cps[s]);
+            }
+        }
+        thread_local TrabajoTabla trabajoRachas;
+        CodigoBinario codigoRacha[formato::kClasesRacha] = {};
+        if (parametros.rachasFondo) {
+            construirTablaCanonica(conteoRachas, parametros.longitudMaxima, trabajoRachas);
+            for (size_t k = 0; k < trabajoRachas.simbolos.size(); ++k) {
+                codigoRacha[trabajoRachas.simbolos[k]] = trabajoRachas.codigos[k];
+            }
+            formato::escribirTablaCanonica(tablas, trabajoRachas.simbolos, trabajoRachas.longitudes);
+        }
+        if (parametros.intercalado) {
+            PayloadIntercalado salida(payload, codigos, numTablas, codigoRacha);
+            escribirPayload(bloque, parametros, cps, simbolos, tablaInicial, tablaDe, numTablas, salida,
+                            resultado.indice.grupos);
+            bytesGrupo = salida.bytesPorStream();
+        } else {
+            PayloadHuffman salida(payload, codigos, numTablas, codigoRacha);
+            escribirPayload(bloque, parametros, cps, simbolos, tablaInicial, tablaDe, numTablas, salida,
+                            resultado.indice.grupos);
+        }
+    }
+    const std::string bytes = payload.str();
+
+    // 5. Frame: tipo | filas | tabla(s) o referencia a la compartida |
+    // [rachas] | [contextos] | [grupos] | tamaño del payload | payload
+    std::ostringstream out(std::ios::binary);
+    out.put(static_cast<char>(compartida ? formato::kFrameCompartido : formato::kFrameBloque));
+    formato::escribirVarint(out, bloque.filas());
+    if (compartida) {
+        formato::escribirVarint(out, parametros.compartida->id);
+        formato::escribirU32(out, parametros.compartida->hash);
+    }
+    if (parametros.tablasContexto > 1) {
+        out.put(static_cast<char>(numTablas));
+    }
+    const std::string bytesTablas = tablas.str();
+    out.write(bytesTablas.data(), static_cast<std::streamsize>(bytesTablas.size()));
+    if (numTablas > 1) {
+        out.put(static_cast<char>(tablaInicial));
+        for (uint8_t t : tablaDe) {
+            out.put(static_cast<char>(t));
+        }
+    }
+    if (parametros.rans || parametros.intercalado) {
+        // Un stream por grupo con rANS, kStreamsIntercalados intercalando
+        const size_t porGrupo = parametros.rans ? 1 : formato::kStreamsIntercalados;
+        const auto& grupos = resultado.indice.grupos;
+        formato::escribirVarint(out, grupos.size());
+        for (size_t g = 0; g < grupos.size(); ++g) {
+            const uint64_t filaFinal = g + 1 < grupos.size() ? grupos[g + 1].filaInicial : bloque.filas();
+            formato::escribirVarint(out, filaFinal - grupos[g].filaInicial);
+            for (size_t k = 0; k < porGrupo; ++k) {
+                formato::escribirVarint(out, bytesGrupo[g * porGrupo + k]);
+            }
+        }
+    }
+    formato::escribirVarint(out, bytes.size());
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    resultado.bytes = out.str();
+    return resultado;
+}
+
+// Parámetros de todos los frames de una salida según 'opciones'. 'perfil'
+// da el fondo y los símbolos distintos del texto; sin él (un flujo) no hay
+// rachas de fondo ni se sabe cuántos símbolos hay, así que el límite de cada
+// tabla queda en el pedido y la cabecera declara el peor caso (ver
+// longitudCabecera).
+ParametrosFrame armarParametros(const OpcionesCompresion& opciones, const PerfilTexto* perfil,
+                                const CodigosCompartidos* compartida)
+{
+    ParametrosFrame parametros;
+    if (perfil != nullptr) {
+        parametros.cols = perfil->columnas;
+        parametros.fondo = perfil->masFrecuente;
+    }
+    parametros.irregular = opciones.filasIrregulares || perfil == nullptr;
+    // La tabla compartida solo reemplaza a la única tabla de un frame simple
+    parametros.compartida = compartida;
+    const bool hayCompartida = compartida != nullptr;
+    parametros.bwt = opciones.bwt && !hayCompartida;
+    parametros.nivelLZ = opciones.nivelLZ > 0 && !parametros.bwt && !hayCompartida
+        ? std::min(opciones.nivelLZ, kMaxNivelLZ) : 0;
+    const bool transformado = parametros.nivelLZ > 0 || parametros.bwt;
+    // Con filas irregulares un fondo '\n' nunca aparece dentro de una fila:
+    // no hay rachas que codificar. Con LZ77 o BWT las rachas ya salen de la
+    // transformación.
+    parametros.rachasFondo = opciones.rachasFondo && perfil != nullptr && !transformado && !hayCompartida &&
+        !(opciones.filasIrregulares && perfil->masFrecuente == kFinFila);
+    parametros.rans = opciones.rans && !transformado && !hayCompartida;
+    // rANS ya intercala sus estados
+    parametros.intercalado = opciones.intercalado && !parametros.rans && !transformado;
+    // Ningún bloque tiene más símbolos que el archivo más el 0 y el fin de
+    // fila del modo irregular (más las clases de largo con LZ77), ni más
+    // clases de racha que kClasesRacha, así que este límite alcanza para todas
+    // las tablas.
+    if (opciones.longitudMaxima > 0 && !parametros.rans) {
+        size_t simbolos = perfil != nullptr ? perfil->simbolosDistintos + 2 : 1;
+        if (parametros.rachasFondo) {
+            simbolos = std::max<size_t>(simbolos, formato::kClasesRacha);
+        }
+        if (parametros.nivelLZ > 0 && perfil != nullptr) {
+            simbolos += formato::kClasesLargoLZ;
+        }
+        parametros.longitudMaxima = HuffmanTree::effectiveMaxLength(simbolos, opciones.longitudMaxima);
+        // La cabecera también tiene que cubrir la tabla compartida
+        if (hayCompartida) {
+            parametros.longitudMaxima = std::max(parametros.longitudMaxima, opciones.tablaCompartida->longitudMaxima);
+        }
+    }
+    parametros.tablasContexto = transformado || hayCompartida
+        ? 1 : std::min<size_t>(std::max<size_t>(opciones.tablasContexto, 1), formato::kMaxTablasContexto);
+    return parametros;
+}
+
+// Flags de la cabecera que dependen de los parámetros de los frames.
+uint8_t flagsFrames(const ParametrosFrame& parametros)
+{
+    uint8_t flags = formato::kFlagCanonico;
+    if (parametros.irregular) {
+        flags |= formato::kFlagIrregular;
+    }
+    if (parametros.rachasFondo) {
+        flags |= formato::kFlagRachasFondo;
+    }
+    if (parametros.tablasContexto > 1) {
+        flags |= formato::kFlagContexto;
+    }
+    if (parametros.rans) {
+        flags |= formato::kFlagRANS;
+    }
+    if (parametros.intercalado) {
+        flags |= formato::kFlagIntercalado;
+    }
+    if (parametros.longitudMaxima > 0) {
+        flags |= formato::kFlagLongitudMaxima;
+    }
+    return flags;
+}
+
+// Lee bloques de filas de 'lector' y pasa cada frame a 'escribir' en el orden
+// de lectura. Con 'medidor' cada bloque también se mide al leerlo. Devuelve
+// false si la lectura falló.
+template <class Escribir>
+bool codificarBloques(LectorLineas& lector, const ParametrosFrame& parametros, const OpcionesCompresion& opciones,
+                      MedidorPerfil* medidor, Escribir escribir)
+{
+    // En modo irregular las celdas de un bloque son sus caracteres más un fin
+    // por fila, así que se acotan el tamaño del bloque y las filas por separado.
+    const bool irregular = parametros.irregular;
+    const size_t maxCeldas = parametros.bwt ? kMaxCeldasBWT : kMaxCeldasBloque;
+    const size_t tamBloque = irregular
+        ? std::min(std::max<size_t>(opciones.tamBloque, 1), maxCeldas)
+        : std::max<size_t>(opciones.tamBloque, 1);
+    const size_t maxFilas = irregular ? maxCeldas
+        : parametros.cols > 0 ? std::max<size_t>(maxCeldas / parametros.cols, 1)
+        : std::numeric_limits<size_t>::max();
+
+    const size_t hilos = PoolHilos::resolverHilos(opciones.hilos);
+    if (hilos <= 1) {
+        BloqueTexto bloque;
+        while (lector.leerBloque(bloque, tamBloque, maxFilas)) {
+            if (medidor != nullptr) {
+                medidor->agregar(bloque);
+            }
+            FrameCodificado frame = codificarFrame(bloque, parametros);
+            escribir(frame);
+            bloque.clear();
+        }
+    } else {
+        // La lectura es secuencial; histograma, árbol y bits de cada bloque van
+        // al pool. Los frames se escriben en el orden de lectura, así que la
+        // salida es idéntica con cualquier cantidad de hilos. La ventana de
+        // bloques en vuelo acota la memoria a ~2 bloques por hilo.
+        PoolHilos pool(hilos);
+        const size_t maxEnVuelo = 2 * hilos;
+        std::deque<std::future<FrameCodificado>> enVuelo;
+        auto escribirSiguiente = [&]() {
+            FrameCodificado frame = enVuelo.front().get();
+            enVuelo.pop_front();
+            escribir(frame);
+        };
+        auto listo = [&]() {
+            return enVuelo.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+
+        auto bloque = std::make_shared<BloqueTexto>();
+        while (lector.leerBloque(*bloque, tamBloque, maxFilas)) {
+            if (medidor != nullptr) {
+                medidor->agregar(*bloque);
+            }
+            enVuelo.push_back(pool.enviar([bloque, &parametros]() {
+                return codificarFrame(*bloque, parametros);
+            }));
+            bloque = std::make_shared<BloqueTexto>();
+            // Lo que ya terminó sale antes de esperar el bloque siguiente
+            while (!enVuelo.empty() && (enVuelo.size() >= maxEnVuelo || listo())) {
+                escribirSiguiente();
+            }
+        }
+        while (!enVuelo.empty()) {
+            escribirSiguiente();
+        }
+    }
+    return !lector.huboError() && lector.abierto();
+}
+
+// Longitud máxima que declara la cabecera de un flujo: la de cualquier tabla
+// que pueda armar un bloque, con todos los codepoints posibles. Es solo una
+// cota (el decoder arma las tablas de búsqueda con la de cada tabla), así que
+// no cambia cómo se decodifica.
+int longitudCabecera(const ParametrosFrame& parametros)
+{
+    size_t simbolos = 0x110000 + 1;
+    if (parametros.nivelLZ > 0) {
+        simbolos += formato::kClasesLargoLZ;
+    }
+    return HuffmanTree::effectiveMaxLength(simbolos, parametros.longitudMaxima);
+}
+
+// Escribe el archivo v3 leyendo 'rutaEntrada' con la codificación de
+// 'perfil'. Con 'unaPasada' el resto de 'perfil' todavía no se conoce: se
+// mide sobre los mismos bloques que se comprimen y filas, columnas y
+// longitud máxima se completan en la cabecera al final. Devuelve false si el
+// texto no se pudo leer con esa codificación.
+bool escribirArchivoBloques(const std::string& rutaEntrada, const std::string& rutaSalida,
+                            const OpcionesCompresion& opciones, PerfilTexto& perfil, bool unaPasada,
+                            EstadisticasCompresion& stats)
+{
+    std::ofstream out(rutaSalida, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("No se pudo crear el archivo binario: " + rutaSalida);
+    }
+
+    // Cabecera global: las columnas son las de la matriz completa, así que
+    // todos los bloques rellenan hasta el mismo ancho (salvo en modo irregular,
+    // donde solo informan el ancho máximo).
+    out.write(formato::kFirma, sizeof(formato::kFirma));
+    out.put(static_cast<char>(formato::kVersionBloques));
+    CodigosCompartidos codigosCompartidos;
+    if (opciones.tablaCompartida) {
+        armarCodigosCompartidos(*opciones.tablaCompartida, codigosCompartidos);
+    }
+    const CodigosCompartidos* compartida = opciones.tablaCompartida ? &codigosCompartidos : nullptr;
+    const ParametrosFrame parametros = armarParametros(opciones, &perfil, compartida);
+    out.put(static_cast<char>(flagsFrames(parametros) | formato::kFlagIndice));
+    const std::streampos posDimensiones = out.tellp();
+    if (unaPasada) {
+        formato::escribirVarintFijo(out, 0);
+        formato::escribirVarintFijo(out, 0);
+    } else {
+        formato::escribirVarint(out, perfil.filas);
+        formato::escribirVarint(out, perfil.columnas);
+    }
+    const std::streampos posLongitud = out.tellp();
+    if (parametros.longitudMaxima > 0) {
+        out.put(static_cast<char>(parametros.longitudMaxima));
+    }
+    if (parametros.rachasFondo) {
+        formato::escribirVarint(out, parametros.fondo);
+    }
+    // Hueco para la posición del índice; se completa al final
+    const std::streampos posHuecoIndice = out.tellp();
+    formato::escribirU64(out, 0);
+
+    // Un frame por bloque de filas
+    std::vector<formato::FrameIndice> indice;
+    LectorLineas lector(rutaEntrada, perfil.codificacion, perfil.offset);
+    MedidorPerfil medidor;
+    const bool leido = codificarBloques(lector, parametros, opciones, unaPasada ? &medidor : nullptr,
+                                        [&](FrameCodificado& frame) {
+        frame.indice.offset = static_cast<uint64_t>(out.tellp());
+        out.write(frame.bytes.data(), static_cast<std::streamsize>(frame.bytes.size()));
+        indice.push_back(std::move(frame.indice));
+        ++stats.bloques;
+    });
+    if (!leido) {
+        return false;
+    }
+    if (unaPasada) {
+        medidor.terminar(lector, perfil);
+    }
+
+    out.put(static_cast<char>(formato::kFrameFin));
+
+    // Índice al final y lo que faltaba de la cabecera
+    const uint64_t posIndice = static_cast<uint64_t>(out.tellp());
+    formato::escribirIndice(out, indice);
+    const std::streampos posFinal = out.tellp();
+    if (unaPasada) {
+        // Las tablas ya respetan el límite de cada bloque; la cabecera declara
+        // el de todo el archivo, que es el mayor
+        out.seekp(posDimensiones);
+        formato::escribirVarintFijo(out, perfil.filas);
+        formato::escribirVarintFijo(out, perfil.columnas);
+        if (parametros.longitudMaxima > 0) {
+            out.seekp(posLongitud);
+            out.put(static_cast<char>(armarParametros(opciones, &perfil, compartida).longitudMaxima));
+        }
+    }
+    out.seekp(posHuecoIndice);
+    formato::escribirU64(out, posIndice);
+    out.seekp(posFinal);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Error escribiendo el archivo binario: " + rutaSalida);
+    }
+    stats.bytesSalida = static_cast<uint64_t>(out.tellp());
+    return true;
+}
+
+} // namespace
+
+EstadisticasCompresion comprimirArchivo(
+    const std::string& rutaEntrada,
+    const std::string& rutaSalida,
+    const OpcionesCompresion& opciones)
+{
+    // 1. Primera pasada: codificación, dimensiones y fondo. No se puede fundir
+    // con la segunda: cada frame ya rellena sus filas hasta el ancho de la
+    // matriz completa con el fondo del archivo, y ninguno de los dos se conoce
+    // hasta leer la última fila. Esta pasada solo cuenta, sin guardar celdas.
+    // Con filas irregulares y sin rachas de fondo los frames no usan ni el
+    // ancho ni el fondo, así que no hace falta: se comprime directamente y,
+    // como en perfilarArchivo, lo que no resulta UTF-8 válido se vuelve a
+    // empezar como Latin-1.
+    const bool unaPasada = opciones.filasIrregulares && !opciones.rachasFondo;
+    const std::string errorCarga = "Fallo al cargar o normalizar el texto: " + rutaEntrada;
+    PerfilTexto perfil;
+    EstadisticasCompresion stats;
+    if (unaPasada) {
+        if (!Normalizer::detectarCodificacion(rutaEntrada, perfil)) {
+            throw std::runtime_error(errorCarga);
+        }
+        bool escrito = escribirArchivoBloques(rutaEntrada, rutaSalida, opciones, perfil, true, stats);
+        if (!escrito && perfil.codificacion == Codificacion::UTF8) {
+            perfil = PerfilTexto();
+            perfil.codificacion = Codificacion::Latin1;
+            stats = EstadisticasCompresion();
+            escrito = escribirArchivoBloques(rutaEntrada, rutaSalida, opciones, perfil, true, stats);
+        }
+        if (!escrito || perfil.totalCodepoints == 0) {
+            std::remove(rutaSalida.c_str());
+            throw std::runtime_error(errorCarga);
+        }
+    } else {
+        if (!Normalizer::perfilarArchivo(rutaEntrada, perfil) || perfil.totalCodepoints == 0) {
+            throw std::runtime_error(errorCarga);
+        }
+        // 2. Segunda pasada: un frame por bloque de filas
+        if (!escribirArchivoBloques(rutaEntrada, rutaSalida, opciones, perfil, false, stats)) {
+            throw std::runtime_error("Error leyendo el archivo durante la compresión: " + rutaEntrada);
+        }
+    }
+
+    stats.filas = perfil.filas;
+    stats.columnas = perfil.columnas;
+    stats.fondo = perfil.masFrecuente;
+    stats.simbolosDistintos = perfil.simbolosDistintos;
+    return stats;
+}
+
+EstadisticasCompresion comprimirFlujo(std::istream& entrada, std::ostream& salida, const OpcionesCompresion& opciones)
+{
+    EstadisticasCompresion stats;
+    auto escribir = [&](const char* bytes, size_t n) {
+        salida.write(bytes, static_cast<std::streamsize>(n));
+        stats.bytesSalida += n;
+    };
+
+    // 1. Cabecera: sin dimensiones ni índice, siempre con filas irregulares
+    CodigosCompartidos codigosCompartidos;
+    if (opciones.tablaCompartida) {
+        armarCodigosCompartidos(*opciones.tablaCompartida, codigosCompartidos);
+    }
+    const ParametrosFrame parametros =
+        armarParametros(opciones, nullptr, opciones.tablaCompartida ? &codigosCompartidos : nullptr);
+    std::ostringstream cabecera(std::ios::binary);
+    cabecera.write(formato::kFirma, sizeof(formato::kFirma));
+    cabecera.put(static_cast<char>(formato::kVersionFlujo));
+    cabecera.put(static_cast<char>(flagsFrames(parametros)));
+    if (parametros.longitudMaxima > 0) {
+        cabecera.put(static_cast<char>(longitudCabecera(parametros)));
+    }
+    const std::string bytesCabecera = cabecera.str();
+    escribir(bytesCabecera.data(), bytesCabecera.size());
+    salida.flush();
+
+    // 2. Un frame por bloque, enviado apenas está listo
+    LectorLineas lector(entrada);
+    const bool leido = codificarBloques(lector, parametros, opciones, nullptr, [&](FrameCodificado& frame) {
+        escribir(frame.bytes.data(), frame.bytes.size());
+        salida.flush();
+        stats.filas += frame.indice.filas;
+        ++stats.bloques;
+    });
+    if (!leido) {
+        throw std::runtime_error("La entrada no es UTF-8 válido ni UTF-16 con BOM (Latin-1 se reconoce "
+                                 "solo desde su primer carácter no ASCII).");
+    }
+
+    // 3. Cierre con el total de filas y si el texto terminaba en '\n'
+    std::ostringstream cierre(std::ios::binary);
+    cierre.put(static_cast<char>(formato::kFrameFin));
+    formato::escribirVarint(cierre, stats.filas);
+    cierre.put(static_cast<char>(stats.filas > 0 && lector.saltosDeLinea() == stats.filas ? 1 : 0));
+    const std::string bytesCierre = cierre.str();
+    escribir(bytesCierre.data(), bytesCierre.size());
+    salida.flush();
+    if (!salida) {
+        throw std::runtime_error("Error escribiendo la salida comprimida.");
+    }
+    return stats;
+}
+
+TablaCompartida entrenarTablaCompartida(const std::vector<std::string>& rutasMuestra, uint32_t id,
+                                        int longitudMaxima)
+{
+    // 1. Frecuencias de todas las muestras, como las ve un frame irregular
+    Histograma conteo;
+    for (const std::string& ruta : rutasMuestra) {
+        PerfilTexto perfil;
+        if (!Normalizer::perfilarArchivo(ruta, perfil)) {
+            throw std::runtime_error("Fallo al cargar o normalizar el texto: " + ruta);
+        }
+        LectorLineas lector(ruta, perfil.codificacion, perfil.offset);
+        BloqueTexto bloque;
+        while (lector.leerBloque(bloque, kMaxCeldasBloque, kMaxCeldasBloque)) {
+            conteo.contar(bloque.codepoints);
+            conteo.sumar(kFinFila, bloque.filas());
+            bloque.clear();
+        }
+        if (lector.huboError() || !lector.abierto()) {
+            throw std::runtime_error("Error leyendo la muestra: " + ruta);
+        }
+    }
+    // Un carácter común que justo no salió en las muestras no debería dejar
+    // a un archivo sin la tabla
+    for (uint32_t cp = ' '; cp < 0x7F; ++cp) {
+        if (conteo.frecuencia(cp) == 0) {
+            conteo.sumar(cp);
+        }
+    }
+    if (conteo.frecuencia(kFinFila) == 0) {
+        conteo.sumar(kFinFila);
+    }
+
+    // 2. Tabla canónica, siempre con límite: el decoder no admite más
+    const int limite = longitudMaxima > 0 ? longitudMaxima : HuffmanTree::kMaxLimitedLength;
+    TrabajoTabla trabajo;
+    TablaCompartida tabla;
+    tabla.id = id;
+    construirTablaCanonica(conteo, HuffmanTree::effectiveMaxLength(conteo.distintos(), limite), trabajo);
+    tabla.simbolos = trabajo.simbolos;
+    tabla.longitudes = trabajo.longitudes;
+    for (uint32_t longitud : tabla.longitudes) {
+        tabla.longitudMaxima = std::max(tabla.longitudMaxima, static_cast<int>(longitud));
+    }
+    tabla.hash = hashTablaCompartida(tabla);
+    return tabla;
+}
+
+} // namespace huffman
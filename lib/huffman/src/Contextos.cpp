@@ -0,0 +1,233 @@
+#include "huffman/Contextos.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace huffman {
+
+namespace {
+
+// Vueltas de refinamiento: cada una mueve los contextos al mejor grupo.
+constexpr int kVueltasRefinamiento = 3;
+
+// Bits aproximados que cuesta guardar una tabla: unos bytes fijos más el
+// codepoint (varint) y la longitud de cada símbolo.
+constexpr double kBitsPorTabla = 24.0;
+constexpr double kBitsPorSimboloTabla = 16.0;
+
+inline double xlog2x(double x) {
+    return x > 0 ? x * std::log2(x) : 0.0;
+}
+
+// Histograma de un grupo de contextos. Va por índice de símbolo del frame
+// (no por codepoint) y se le restan contextos al refinar, así que es un
+// arreglo del tamaño del alfabeto y no un Histograma.
+struct Grupo {
+    std::vector<uint64_t> frecuencias;
+    uint64_t total = 0;
+    size_t presentes = 0;   // símbolos con frecuencia > 0
+    size_t contextos = 0;
+
+    // Bits de codificar el grupo con su propia entropía: N log N - sum f log f.
+    double costo() const {
+        double suma = 0;
+        for (uint64_t f : frecuencias) {
+            suma += xlog2x(static_cast<double>(f));
+        }
+        return xlog2x(static_cast<double>(total)) - suma;
+    }
+
+    double costoTabla() const { return kBitsPorTabla + kBitsPorSimboloTabla * static_cast<double>(presentes); }
+};
+
+// Un contexto como lista de (símbolo, veces) sin ceros.
+using Disperso = std::vector<std::pair<uint32_t, uint32_t>>;
+
+// Cuánto aumenta el costo del grupo al sumarle el contexto (sin tocarlo).
+double aumento(const Grupo& g, const Disperso& c, uint64_t totalContexto) {
+    double delta = xlog2x(static_cast<double>(g.total + totalContexto)) - xlog2x(static_cast<double>(g.total));
+    for (const auto& par : c) {
+        const double antes = static_cast<double>(g.frecuencias[par.first]);
+        delta -= xlog2x(antes + par.second) - xlog2x(antes);
+        if (antes == 0) {
+            delta += kBitsPorSimboloTabla;
+        }
+    }
+    return delta;
+}
+
+void sumar(Grupo& g, const Disperso& c, uint64_t totalContexto) {
+    for (const auto& par : c) {
+        g.presentes += g.frecuencias[par.first] == 0;
+        g.frecuencias[par.first] += par.second;
+    }
+    g.total += totalContexto;
+    ++g.contextos;
+}
+
+void restar(Grupo& g, const Disperso& c, uint64_t totalContexto) {
+    for (const auto& par : c) {
+        g.frecuencias[par.first] -= par.second;
+        g.presentes -= g.frecuencias[par.first] == 0;
+    }
+    g.total -= totalContexto;
+    --g.contextos;
+}
+
+} // namespace
+
+std::vector<uint8_t> agruparContextos(
+    const std::vector<uint32_t>& conteos,
+    size_t numContextos,
+    size_t numSimbolos,
+    size_t maxTablas)
+{
+    std::vector<uint8_t> asignacion(numContextos, 0);
+
+    // 1. Contextos con apariciones, de más a menos frecuente
+    std::vector<Disperso> dispersos(numContextos);
+    std::vector<uint64_t> totales(numContextos, 0);
+    std::vector<size_t> activos;
+    for (size_t c = 0; c < numContextos; ++c) {
+        const uint32_t* fila = conteos.data() + c * numSimbolos;
+        for (size_t s = 0; s < numSimbolos; ++s) {
+            if (fila[s] != 0) {
+                dispersos[c].emplace_back(static_cast<uint32_t>(s), fila[s]);
+                totales[c] += fila[s];
+            }
+        }
+        if (totales[c] != 0) {
+            activos.push_back(c);
+        }
+    }
+    const size_t k = std::min(maxTablas, activos.size());
+    if (k <= 1) {
+        return asignacion;
+    }
+    std::stable_sort(activos.begin(), activos.end(), [&totales](size_t a, size_t b) {
+        return totales[a] > totales[b];
+    });
+
+    // 2. Semillas: los k contextos más frecuentes; el resto va donde menos cuesta
+    std::vector<Grupo> grupos(k);
+    for (auto& g : grupos) {
+        g.frecuencias.assign(numSimbolos, 0);
+    }
+    auto mejorGrupo = [&](size_t c) {
+        size_t mejor = 0;
+        double mejorDelta = 0;
+        for (size_t g = 0; g < k; ++g) {
+            double delta = aumento(grupos[g], dispersos[c], totales[c]);
+            if (grupos[g].contextos == 0) {
+                delta += kBitsPorTabla;
+            }
+            if (g == 0 || delta < mejorDelta) {
+                mejor = g;
+                mejorDelta = delta;
+            }
+        }
+        return mejor;
+    };
+    for (size_t i = 0; i < activos.size(); ++i) {
+        const size_t c = activos[i];
+        const size_t g = i < k ? i : mejorGrupo(c);
+        asignacion[c] = static_cast<uint8_t>(g);
+        sumar(grupos[g], dispersos[c], totales[c]);
+    }
+
+    // 3. Refinamiento: cada contexto se muda al grupo que menos crece con él
+    for (int vuelta = 0; vuelta < kVueltasRefinamiento; ++vuelta) {
+        bool cambio = false;
+        for (size_t c : activos) {
+            const size_t actual = asignacion[c];
+            restar(grupos[actual], dispersos[c], totales[c]);
+            const size_t nuevo = mejorGrupo(c);
+            sumar(grupos[nuevo], dispersos[c], totales[c]);
+            if (nuevo != actual) {
+                asignacion[c] = static_cast<uint8_t>(nuevo);
+                cambio = true;
+            }
+        }
+        if (!cambio) {
+            break;
+        }
+    }
+
+    // 4. Fusión: mientras juntar dos grupos cueste menos bits de payload que
+    // los que ahorra su tabla, se junta el par más barato
+    std::vector<size_t> vivos;
+    for (size_t g = 0; g < k; ++g) {
+        if (grupos[g].contextos != 0) {
+            vivos.push_back(g);
+        }
+    }
+    std::vector<size_t> destino(k);
+    for (size_t g = 0; g < k; ++g) {
+        destino[g] = g;
+    }
+    std::vector<double> costos(k);
+    for (size_t g : vivos) {
+        costos[g] = grupos[g].costo();
+    }
+    Grupo fusion;
+    while (vivos.size() > 1) {
+        double mejorAhorro = 0;
+        size_t mejorA = 0;
+        size_t mejorB = 0;
+        double mejorCosto = 0;
+        for (size_t a = 0; a < vivos.size(); ++a) {
+            for (size_t b = a + 1; b < vivos.size(); ++b) {
+                const Grupo& ga = grupos[vivos[a]];
+                const Grupo& gb = grupos[vivos[b]];
+                fusion.frecuencias.resize(numSimbolos);
+                fusion.presentes = 0;
+                for (size_t s = 0; s < numSimbolos; ++s) {
+                    fusion.frecuencias[s] = ga.frecuencias[s] + gb.frecuencias[s];
+                    fusion.presentes += fusion.frecuencias[s] != 0;
+                }
+                fusion.total = ga.total + gb.total;
+                const double costo = fusion.costo();
+                const double ahorro = costos[vivos[a]] + ga.costoTabla() + costos[vivos[b]] + gb.costoTabla()
+                    - costo - fusion.costoTabla();
+                if (ahorro > mejorAhorro) {
+                    mejorAhorro = ahorro;
+                    mejorA = a;
+                    mejorB = b;
+                    mejorCosto = costo;
+                }
+            }
+        }
+        if (mejorAhorro <= 0) {
+            break;
+        }
+        Grupo& ga = grupos[vivos[mejorA]];
+        Grupo& gb = grupos[vivos[mejorB]];
+        ga.presentes = 0;
+        for (size_t s = 0; s < numSimbolos; ++s) {
+            ga.frecuencias[s] += gb.frecuencias[s];
+            ga.presentes += ga.frecuencias[s] != 0;
+        }
+        ga.total += gb.total;
+        ga.contextos += gb.contextos;
+        costos[vivos[mejorA]] = mejorCosto;
+        destino[vivos[mejorB]] = vivos[mejorA];
+        vivos.erase(vivos.begin() + static_cast<std::ptrdiff_t>(mejorB));
+    }
+
+    // 5. Numeración sin huecos en el orden de los grupos que quedaron
+    std::vector<uint8_t> numero(k, 0);
+    for (size_t i = 0; i < vivos.size(); ++i) {
+        numero[vivos[i]] = static_cast<uint8_t>(i);
+    }
+    for (size_t c : activos) {
+        size_t g = asignacion[c];
+        while (destino[g] != g) {
+            g = destino[g];
+        }
+        asignacion[c] = numero[g];
+    }
+    return asignacion;
+}
+
+} // namespace huffman
@@ -0,0 +1,131 @@
+#include "huffman/Formato.hpp"
+#include <algorithm>
+
+namespace huffman {
+namespace formato {
+
+void escribirVarint(std::ostream& out, uint64_t valor) {
+    while (valor >= 0x80) {
+        out.put(static_cast<char>((valor & 0x7F) | 0x80));
+        valor >>= 7;
+    }
+    out.put(static_cast<char>(valor));
+}
+
+uint32_t claseLZ(uint32_t valor) {
+    if (valor < 8) {
+        return valor;
+    }
+    uint32_t k = 3;
+    while (valor >> (k + 1)) {
+        ++k;
+    }
+    return 8 + 2 * (k - 3) + ((valor >> (k - 1)) & 1);
+}
+
+uint32_t bitsExtraLZ(uint32_t clase) {
+    return clase < 8 ? 0 : 2 + (clase - 8) / 2;
+}
+
+uint32_t baseLZ(uint32_t clase) {
+    if (clase < 8) {
+        return clase;
+    }
+    return (2 + ((clase - 8) & 1)) << bitsExtraLZ(clase);
+}
+
+size_t pasoPuntosBWT(size_t largo, uint32_t numPuntos) {
+    return std::max<size_t>((largo + numPuntos - 1) / numPuntos, 1);
+}
+
+void escribirTablaCanonica(
+    std::ostream& out,
+    const std::vector<uint32_t>& simbolos,
+    const std::vector<uint32_t>& longitudes)
+{
+    escribirVarint(out, simbolos.size());
+    if (simbolos.empty()) {
+        return;
+    }
+
+    // Cuántos códigos hay de cada longitud; con eso y el orden de los
+    // símbolos el decoder reconstruye los códigos canónicos.
+    uint32_t longitudMaxima = longitudes.back();
+    uint64_t cantidadPorLongitud[256] = {};
+    for (uint32_t longitud : longitudes) {
+        cantidadPorLongitud[longitud]++;
+    }
+
+    out.put(static_cast<char>(longitudMaxima));
+    for (uint32_t len = 1; len <= longitudMaxima; ++len) {
+        escribirVarint(out, cantidadPorLongitud[len]);
+    }
+    for (uint32_t simbolo : simbolos) {
+        escribirVarint(out, simbolo);
+    }
+}
+
+void escribirTablaRANS(
+    std::ostream& out,
+    const std::vector<uint32_t>& simbolos,
+    const std::vector<uint32_t>& frecuencias,
+    int bitsEscala)
+{
+    escribirVarint(out, simbolos.size());
+    if (simbolos.empty()) {
+        return;
+    }
+    out.put(static_cast<char>(bitsEscala));
+    for (size_t i = 0; i < simbolos.size(); ++i) {
+        escribirVarint(out, simbolos[i]);
+        escribirVarint(out, frecuencias[i]);
+    }
+}
+
+void escribirIndice(std::ostream& out, const std::vector<FrameIndice>& frames) {
+    escribirVarint(out, frames.size());
+    for (const auto& frame : frames) {
+        escribirVarint(out, frame.offset);
+        escribirVarint(out, frame.filas);
+        escribirVarint(out, frame.grupos.size());
+        for (const auto& grupo : frame.grupos) {
+            escribirVarint(out, grupo.filaInicial);
+            escribirVarint(out, grupo.bitInicial);
+            escribirVarint(out, grupo.simbolos);
+            escribirVarint(out, grupo.bytesSalida);
+        }
+    }
+}
+
+void escribirVarintFijo(std::ostream& out, uint64_t valor) {
+    for (size_t i = 0; i + 1 < kBytesVarintFijo; ++i) {
+        out.put(static_cast<char>((valor & 0x7F) | 0x80));
+        valor >>= 7;
+    }
+    out.put(static_cast<char>(valor & 0x7F));
+}
+
+void escribirU64(std::ostream& out, uint64_t valor) {
+    for (int i = 0; i < 8; ++i) {
+        out.put(static_cast<char>((valor >> (8 * i)) & 0xFF));
+    }
+}
+
+void escribirU32(std::ostream& out, uint32_t valor) {
+    for (int i = 0; i < 4; ++i) {
+        out.put(static_cast<char>((valor >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t hashFNV1a(const void* datos, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(datos);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace formato
+} // namespace huffman
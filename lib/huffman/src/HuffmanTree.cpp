@@ -4,127 +4,141 @@
 
 // Aunque la mayoría ya están en el .hpp, incluimos las
 // librerías que usamos explícitamente en este .cpp
-#include <queue>    // Para std::priority_queue
-#include <vector>   // Para el contenedor de la priority_queue
-#include <memory>   // Para std::make_shared
+#include <algorithm> // Para std::sort
 
 namespace huffman {
 
 /**
- * @brief Constructor de HuffmanTree.
+ * @brief Combina las hojas con dos colas sobre el arreglo de nodos.
  */
-HuffmanTree::HuffmanTree(const std::map<std::string, int>& frequencies)
-    : root(nullptr) // Inicializamos la raíz como nula
+void HuffmanTree::computeCodeLengths(HuffmanNode* nodes, size_t n, uint32_t* lengths, int maxLength)
 {
-    // Si el mapa de frecuencias está vacío, no hay nada que hacer.
-    if (frequencies.empty()) {
+    if (n == 0) {
+        return;
+    }
+    // CASO ESPECIAL: un solo símbolo. Le toca el código '0' por convención.
+    if (n == 1) {
+        nodes[0].left = nodes[0].right = -1;
+        nodes[0].depth = 1;
+        lengths[nodes[0].symbol] = 1;
         return;
     }
 
-    // 1. Construir el árbol
-    buildTree(frequencies);
+    // 1. Hojas por frecuencia creciente; a igual frecuencia, por símbolo, para
+    // que el resultado no dependa del algoritmo de ordenamiento.
+    std::sort(nodes, nodes + n, [](const HuffmanNode& a, const HuffmanNode& b) {
+        return a.frequency != b.frequency ? a.frequency < b.frequency : a.symbol < b.symbol;
+    });
+    for (size_t i = 0; i < n; ++i) {
+        nodes[i].left = nodes[i].right = -1;
+    }
 
-    // 2. Generar los códigos
-    
-    // CASO ESPECIAL: Si solo hay un símbolo (el árbol es solo un nodo hoja).
-    // Asignamos '0' como su código por convención.
-    if (root != nullptr && root->isLeaf()) {
-        huffmanCodes[root->data] = "0";
+    // 2. Dos colas: las hojas en [nextLeaf, n) y los nodos internos en
+    // [nextInternal, created). Cada nodo interno pesa al menos lo mismo que el
+    // anterior, así que ambas colas están ordenadas y el mínimo siempre está
+    // al frente de alguna. Ante empate se prefiere la hoja (árbol más bajo).
+    size_t nextLeaf = 0;
+    size_t nextInternal = n;
+    size_t created = n;
+    auto takeMin = [&]() -> size_t {
+        if (nextLeaf < n &&
+            (nextInternal == created || nodes[nextLeaf].frequency <= nodes[nextInternal].frequency)) {
+            return nextLeaf++;
+        }
+        return nextInternal++;
+    };
+    for (; created < 2 * n - 1; ++created) {
+        const size_t left = takeMin();
+        const size_t right = takeMin();
+        HuffmanNode& parent = nodes[created];
+        parent.frequency = nodes[left].frequency + nodes[right].frequency;
+        parent.left = static_cast<int32_t>(left);
+        parent.right = static_cast<int32_t>(right);
     }
-    // Caso normal: El árbol tiene más de un nodo
-    else {
-        // Empezamos la recursión para generar códigos desde la raíz
-        generateCodes(root, "");
+
+    // 3. Profundidades de la raíz (el último nodo) hacia abajo: los hijos
+    // siempre tienen índice menor que su padre.
+    const size_t root = 2 * n - 2;
+    nodes[root].depth = 0;
+    for (size_t i = root; i >= n; --i) {
+        const uint32_t childDepth = nodes[i].depth + 1;
+        nodes[nodes[i].left].depth = childDepth;
+        nodes[nodes[i].right].depth = childDepth;
     }
-}
 
-/**
- * @brief Obtiene el mapa de códigos de Huffman (getter).
- */
-const std::map<std::string, std::string>& HuffmanTree::getCodes() const
-{
-    // Simplemente devuelve el mapa que ya fue llenado.
-    return huffmanCodes;
+    // 4. Longitud máxima, si se pidió.
+    if (maxLength > 0) {
+        limitCodeLengths(nodes, n, effectiveMaxLength(n, maxLength));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        lengths[nodes[i].symbol] = nodes[i].depth;
+    }
 }
 
-// --- Métodos Privados ---
-
 /**
- * @brief Construye el árbol de Huffman usando una cola de prioridad.
+ * @brief Límite efectivo de longitud para 'n' símbolos.
  */
-void HuffmanTree::buildTree(const std::map<std::string, int>& frequencies)
+int HuffmanTree::effectiveMaxLength(size_t n, int maxLength)
 {
-    // 1. Crear la cola de prioridad (min-heap).
-    // Esta cola ordenará los nodos usando nuestro 'CompareNode'
-    // para que los nodos con MENOR frecuencia salgan primero.
-    std::priority_queue<std::shared_ptr<HuffmanNode>,
-                        std::vector<std::shared_ptr<HuffmanNode>>,
-                        CompareNode> pq;
-
-    // 2. Poblar la cola de prioridad con los nodos hoja.
-    // Iteramos sobre el mapa de frecuencias que recibimos.
-    for (const auto& pair : frequencies) {
-        // 'pair.first' es el std::string (símbolo, ej: "2f")
-        // 'pair.second' es el int (frecuencia)
-        
-        // Creamos un nuevo nodo hoja y lo añadimos a la cola.
-        // Usamos std::make_shared para crear el puntero inteligente.
-        pq.push(std::make_shared<HuffmanNode>(pair.first, pair.second));
-    }
-
-    // 3. Construir el árbol.
-    // El bucle se ejecuta mientras haya más de un nodo en la cola.
-    while (pq.size() > 1) {
-        // 3a. Sacar los dos nodos con menor frecuencia
-        std::shared_ptr<HuffmanNode> left = pq.top();
-        pq.pop();
-
-        std::shared_ptr<HuffmanNode> right = pq.top();
-        pq.pop();
-
-        // 3b. Crear un nuevo nodo INTERNO con estos dos como hijos.
-        // Nuestro constructor de HuffmanNode se encarga de sumar
-        // las frecuencias (left->frequency + right->frequency).
-        auto parent = std::make_shared<HuffmanNode>(left, right);
-
-        // 3c. Añadir el nuevo nodo padre de vuelta a la cola.
-        // La cola lo reordenará según su nueva frecuencia (la suma).
-        pq.push(parent);
-    }
-
-    // 4. Fin del bucle.
-    // Si la cola no estaba vacía, el único nodo que queda
-    // es el nodo raíz de todo el árbol.
-    if (!pq.empty()) {
-        root = pq.top();
+    int needed = 0;
+    while (needed < kMaxLimitedLength && (size_t(1) << needed) < n) {
+        ++needed;
     }
+    return std::max(std::min(maxLength, kMaxLimitedLength), std::max(needed, 1));
 }
 
 /**
- * @brief Función recursiva (DFS) para generar los códigos binarios.
+ * @brief Recorta las longitudes al límite y cierra de nuevo la suma de Kraft.
+ *
+ * Se cuenta cuántas hojas hay de cada longitud, con las demasiado largas ya
+ * puestas en 'maxLength'. La suma de Kraft, en unidades de 2^-maxLength,
+ * queda entonces por encima de 2^maxLength; cada vuelta quita un código de
+ * longitud máxima y parte en dos uno de la longitud más larga posible por
+ * debajo, lo que baja la suma exactamente en una unidad sin cambiar la
+ * cantidad de códigos.
  */
-void HuffmanTree::generateCodes(std::shared_ptr<HuffmanNode> node, const std::string& currentCode)
+void HuffmanTree::limitCodeLengths(HuffmanNode* nodes, size_t n, int maxLength)
 {
-    // Caso base de seguridad: si el nodo es nulo, no hacer nada.
-    if (node == nullptr) {
+    const uint32_t limit = static_cast<uint32_t>(maxLength);
+    uint64_t count[kMaxLimitedLength + 1] = {};
+    bool exceeded = false;
+    for (size_t i = 0; i < n; ++i) {
+        if (nodes[i].depth > limit) {
+            exceeded = true;
+            count[limit]++;
+        } else {
+            count[nodes[i].depth]++;
+        }
+    }
+    if (!exceeded) {
         return;
     }
 
-    // Caso base de la recursión: ¡Es un nodo hoja!
-    if (node->isLeaf()) {
-        // Hemos llegado a un símbolo. Guardamos el código binario
-        // acumulado (currentCode) en nuestro mapa de resultados.
-        huffmanCodes[node->data] = currentCode;
-        return; // Terminamos esta rama de la recursión.
+    uint64_t kraft = 0;
+    for (uint32_t len = 1; len <= limit; ++len) {
+        kraft += count[len] << (limit - len);
+    }
+    const uint64_t full = uint64_t(1) << limit;
+    while (kraft > full) {
+        count[limit]--;
+        for (uint32_t len = limit - 1; len > 0; --len) {
+            if (count[len] != 0) {
+                count[len]--;
+                count[len + 1] += 2;
+                break;
+            }
+        }
+        --kraft;
     }
 
-    // Paso recursivo: Este es un nodo interno (no es una hoja).
-    
-    // Ir a la izquierda, añadiendo un '0' al código actual.
-    generateCodes(node->left, currentCode + "0");
-
-    // Ir a la derecha, añadiendo un '1' al código actual.
-    generateCodes(node->right, currentCode + "1");
+    // Las hojas están por frecuencia creciente: las primeras se quedan con
+    // los códigos más largos.
+    size_t i = 0;
+    for (uint32_t len = limit; len > 0; --len) {
+        for (uint64_t k = 0; k < count[len]; ++k) {
+            nodes[i++].depth = len;
+        }
+    }
 }
 
 } // fin del namespace huffman
\ No newline at end of file
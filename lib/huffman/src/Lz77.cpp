@@ -0,0 +1,206 @@
+#include "huffman/Lz77.hpp"
+#include "huffman/Formato.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace huffman {
+
+namespace {
+
+// Entradas de la tabla de cabezas de cadena: 2^16 caben en L2.
+constexpr int kBitsHash = 16;
+
+static_assert(formato::kMinLargoLZ == 3, "el hash mira los 3 bytes de la copia más corta");
+
+struct ParametrosNivel {
+    uint32_t cadena;
+    uint32_t suficiente;
+    bool perezoso;
+};
+
+// Como los niveles de zlib: más candidatos cuanto más alto, y desde el 4
+// parseo perezoso.
+constexpr ParametrosNivel kNiveles[kMaxNivelLZ + 1] = {
+    {0, 0, false},
+    {4, 16, false},
+    {8, 32, false},
+    {16, 64, false},
+    {16, 32, true},
+    {32, 64, true},
+    {64, 128, true},
+    {256, 258, true},
+    {1024, 1024, true},
+    {4096, uint32_t(1) << 16, true},
+};
+
+inline uint32_t hash3(const unsigned char* p) {
+    const uint32_t v = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+    return (v * 2654435761u) >> (32 - kBitsHash);
+}
+
+inline bool esContinuacion(unsigned char b) {
+    return (b & 0xC0) == 0x80;
+}
+
+// Bytes del carácter UTF-8 que empieza con 'b'.
+inline size_t bytesCaracter(unsigned char b) {
+    return b < 0x80 ? 1 : b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+}
+
+inline uint32_t decodificarCaracter(const unsigned char* p, size_t bytes) {
+    switch (bytes) {
+    case 1:
+        return p[0];
+    case 2:
+        return (uint32_t(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+    case 3:
+        return (uint32_t(p[0] & 0x0F) << 12) | (uint32_t(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+    default:
+        return (uint32_t(p[0] & 0x07) << 18) | (uint32_t(p[1] & 0x3F) << 12) | (uint32_t(p[2] & 0x3F) << 6) |
+               (p[3] & 0x3F);
+    }
+}
+
+// Bytes iguales al comienzo de 'a' y 'b', hasta 'maximo'.
+inline uint32_t comparar(const unsigned char* a, const unsigned char* b, uint32_t maximo) {
+    uint32_t largo = 0;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // De a 8 bytes: el primero distinto es el bit bajo más chico de la diferencia
+    while (largo + 8 <= maximo) {
+        uint64_t x;
+        uint64_t y;
+        std::memcpy(&x, a + largo, sizeof(x));
+        std::memcpy(&y, b + largo, sizeof(y));
+        if (x != y) {
+            return largo + static_cast<uint32_t>(__builtin_ctzll(x ^ y) >> 3);
+        }
+        largo += 8;
+    }
+#endif
+    while (largo < maximo && a[largo] == b[largo]) {
+        ++largo;
+    }
+    return largo;
+}
+
+} // namespace
+
+BuscadorLZ::BuscadorLZ(int nivel)
+    : cabeza_(size_t(1) << kBitsHash, 0),
+      previa_(formato::kVentanaLZ, 0)
+{
+    const ParametrosNivel& p = kNiveles[std::min(std::max(nivel, kMinNivelLZ), kMaxNivelLZ)];
+    cadena_ = p.cadena;
+    suficiente_ = p.suficiente;
+    perezoso_ = p.perezoso;
+}
+
+uint32_t BuscadorLZ::buscar(const unsigned char* texto, size_t n, size_t i, uint32_t& distancia) const {
+    if (i + formato::kMinLargoLZ > n) {
+        return 0;
+    }
+    const uint32_t maximo = static_cast<uint32_t>(std::min<size_t>(n - i, formato::kMaxLargoLZ));
+    const uint32_t actual = base_ + static_cast<uint32_t>(i);
+    const uint32_t limite = std::max(base_, actual > formato::kVentanaLZ ? actual - formato::kVentanaLZ : 0u);
+    const unsigned char* p = texto + i;
+
+    uint32_t mejor = formato::kMinLargoLZ - 1;
+    uint32_t candidato = cabeza_[hash3(p)];
+    for (uint32_t intentos = cadena_; intentos > 0 && candidato >= limite; --intentos) {
+        const unsigned char* c = texto + (candidato - base_);
+        // Sin el byte que haría ganar a este candidato no vale comparar
+        if (c[mejor] == p[mejor] && c[0] == p[0]) {
+            const uint32_t largo = comparar(c, p, maximo);
+            if (largo > mejor) {
+                mejor = largo;
+                distancia = actual - candidato;
+                if (largo >= suficiente_ || largo == maximo) {
+                    break;
+                }
+            }
+        }
+        candidato = previa_[candidato & (formato::kVentanaLZ - 1)];
+    }
+    // La copia termina donde termina un carácter
+    while (mejor >= formato::kMinLargoLZ && i + mejor < n && esContinuacion(p[mejor])) {
+        --mejor;
+    }
+    return mejor >= formato::kMinLargoLZ ? mejor : 0;
+}
+
+void BuscadorLZ::insertar(const unsigned char* texto, size_t n, size_t i) {
+    if (i + formato::kMinLargoLZ > n) {
+        return;
+    }
+    const uint32_t actual = base_ + static_cast<uint32_t>(i);
+    uint32_t& cabeza = cabeza_[hash3(texto + i)];
+    previa_[actual & (formato::kVentanaLZ - 1)] = cabeza;
+    cabeza = actual;
+}
+
+void BuscadorLZ::parsear(const unsigned char* texto, size_t n, std::vector<TokenLZ>& tokens) {
+    // Las posiciones absolutas tienen que seguir cabiendo en 32 bits
+    if (uint64_t(base_) + n >= (uint64_t(1) << 31)) {
+        std::fill(cabeza_.begin(), cabeza_.end(), 0);
+        base_ = 1;
+    }
+
+    auto literal = [&](size_t i) {
+        const size_t bytes = bytesCaracter(texto[i]);
+        tokens.push_back(TokenLZ{0, decodificarCaracter(texto + i, bytes)});
+        return bytes;
+    };
+    // Solo se encadenan posiciones donde empieza un carácter: ninguna copia
+    // empieza en otra parte
+    auto insertarTramo = [&](size_t desde, size_t hasta) {
+        for (size_t p = desde; p < hasta; ++p) {
+            if (!esContinuacion(texto[p])) {
+                insertar(texto, n, p);
+            }
+        }
+    };
+
+    size_t i = 0;
+    uint32_t largo = 0;
+    uint32_t distancia = 0;
+    bool buscado = false;   // 'largo' y 'distancia' ya son los de 'i'
+    while (i < n) {
+        if (!buscado) {
+            largo = buscar(texto, n, i, distancia);
+            insertar(texto, n, i);
+        }
+        buscado = false;
+        if (largo == 0) {
+            i += literal(i);
+            continue;
+        }
+        size_t desde = i + 1;
+        if (perezoso_ && largo < suficiente_) {
+            // Si un carácter más adelante sale una copia más larga, este va
+            // como literal
+            const size_t j = i + bytesCaracter(texto[i]);
+            uint32_t distancia2 = 0;
+            const uint32_t largo2 = buscar(texto, n, j, distancia2);
+            if (largo2 > largo) {
+                insertar(texto, n, j);
+                literal(i);
+                i = j;
+                largo = largo2;
+                distancia = distancia2;
+                buscado = true;
+                continue;
+            }
+            // 'j' se encadena con el resto de la copia; si la copia termina
+            // justo ahí, lo hace la vuelta siguiente (encadenarlo dos veces
+            // haría que su búsqueda se encontrara a sí misma)
+            desde = j;
+        }
+        tokens.push_back(TokenLZ{largo, distancia});
+        insertarTramo(desde, i + largo);
+        i += largo;
+    }
+    base_ += static_cast<uint32_t>(n);
+}
+
+} // namespace huffman
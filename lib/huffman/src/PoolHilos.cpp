@@ -0,0 +1,61 @@
+#include "huffman/PoolHilos.hpp"
+
+namespace huffman {
+
+size_t PoolHilos::resolverHilos(size_t hilos)
+{
+    if (hilos == 0) {
+        hilos = std::thread::hardware_concurrency();
+    }
+    return hilos == 0 ? 1 : hilos;
+}
+
+PoolHilos::PoolHilos(size_t hilos)
+{
+    hilos = resolverHilos(hilos);
+    trabajadores.reserve(hilos);
+    for (size_t i = 0; i < hilos; ++i) {
+        trabajadores.emplace_back([this]() { bucleTrabajador(); });
+    }
+}
+
+PoolHilos::~PoolHilos()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cerrando = true;
+    }
+    hayTarea.notify_all();
+    for (auto& t : trabajadores) {
+        t.join();
+    }
+}
+
+void PoolHilos::encolar(std::function<void()> tarea)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tareas.push_back(std::move(tarea));
+    }
+    hayTarea.notify_one();
+}
+
+// Cada hilo toma tareas hasta que el pool se cierra y la cola queda vacía.
+void PoolHilos::bucleTrabajador()
+{
+    while (true) {
+        std::function<void()> tarea;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            hayTarea.wait(lock, [this]() { return cerrando || !tareas.empty(); });
+            if (tareas.empty()) {
+                return;
+            }
+            tarea = std::move(tareas.front());
+            tareas.pop_front();
+        }
+        tarea();
+    }
+}
+
+} // namespace huffman
@@ -0,0 +1,147 @@
+#include "huffman/Rans.hpp"
+#include "huffman/Formato.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace huffman {
+
+namespace {
+
+// Escala mínima y la que se busca como tope: 2^12 slots caben en L1 y
+// alcanzan para texto con pocos símbolos.
+constexpr int kBitsEscalaMinimos = 12;
+constexpr int kBitsEscalaPreferidos = 15;
+
+// Bytes que puede sacar una operación al renormalizar, como máximo.
+constexpr size_t kBytesPorOperacion = 3;
+
+} // namespace
+
+int bitsEscalaRANS(size_t numSimbolos) {
+    // Unos 8 slots por símbolo como mínimo, para que el redondeo pese poco
+    int bits = kBitsEscalaMinimos;
+    while (bits < kBitsEscalaPreferidos && (size_t(1) << bits) < numSimbolos * 8) {
+        ++bits;
+    }
+    while ((size_t(1) << bits) < numSimbolos) {
+        ++bits;
+    }
+    return bits;
+}
+
+void normalizarFrecuencias(
+    const std::vector<uint64_t>& frecuencias,
+    int bitsEscala,
+    std::vector<uint32_t>& normalizadas)
+{
+    const uint64_t objetivo = uint64_t(1) << bitsEscala;
+    normalizadas.assign(frecuencias.size(), 0);
+    uint64_t total = 0;
+    std::vector<uint32_t> presentes;
+    for (size_t s = 0; s < frecuencias.size(); ++s) {
+        if (frecuencias[s] != 0) {
+            total += frecuencias[s];
+            presentes.push_back(static_cast<uint32_t>(s));
+        }
+    }
+    if (presentes.empty()) {
+        return;
+    }
+
+    const double escala = static_cast<double>(objetivo) / static_cast<double>(total);
+    uint64_t suma = 0;
+    for (uint32_t s : presentes) {
+        const double escalada = std::round(static_cast<double>(frecuencias[s]) * escala);
+        normalizadas[s] = static_cast<uint32_t>(std::max(1.0, std::min(escalada, static_cast<double>(objetivo))));
+        suma += normalizadas[s];
+    }
+
+    // El ajuste va a los más frecuentes: ahí un slot de más o de menos apenas
+    // cambia el costo por símbolo
+    std::stable_sort(presentes.begin(), presentes.end(), [&normalizadas](uint32_t a, uint32_t b) {
+        return normalizadas[a] > normalizadas[b];
+    });
+    if (suma < objetivo) {
+        normalizadas[presentes[0]] += static_cast<uint32_t>(objetivo - suma);
+        return;
+    }
+    uint64_t sobra = suma - objetivo;
+    while (sobra > 0) {
+        const uint64_t base = suma;
+        for (uint32_t s : presentes) {
+            if (sobra == 0) {
+                break;
+            }
+            if (normalizadas[s] <= 1) {
+                continue;
+            }
+            const uint64_t parte = std::max<uint64_t>(1, sobra * normalizadas[s] / base);
+            const uint64_t quitar = std::min<uint64_t>({parte, normalizadas[s] - 1, sobra});
+            normalizadas[s] -= static_cast<uint32_t>(quitar);
+            suma -= quitar;
+            sobra -= quitar;
+        }
+    }
+}
+
+OperacionRANS operacionRANS(uint32_t inicio, uint32_t frecuencia, uint32_t bitsEscala) {
+    OperacionRANS op;
+    op.xMaximo = ((formato::kCotaRANS >> bitsEscala) << 8) * frecuencia;
+    op.complemento = (uint32_t(1) << bitsEscala) - frecuencia;
+    if (frecuencia < 2) {
+        // x / 1: el recíproco 2^32 - 1 da x - 1 y el sesgo lo compensa
+        op.reciproco = ~uint32_t(0);
+        op.corrimiento = 0;
+        op.sesgo = inicio + (uint32_t(1) << bitsEscala) - 1;
+    } else {
+        uint32_t corrimiento = 0;
+        while (frecuencia > (uint32_t(1) << corrimiento)) {
+            ++corrimiento;
+        }
+        op.reciproco = static_cast<uint32_t>(((uint64_t(1) << (corrimiento + 31)) + frecuencia - 1) / frecuencia);
+        op.corrimiento = corrimiento - 1;
+        op.sesgo = inicio;
+    }
+    return op;
+}
+
+void codificarRANS(const std::vector<OperacionRANS>& ops, std::vector<unsigned char>& salida) {
+    constexpr uint32_t kEstados = formato::kEstadosRANS;
+    // Por delante siempre quedan al menos los bytes de los estados, así que
+    // escribir 4 bytes antes de 'p' nunca se sale del buffer
+    std::vector<unsigned char> buffer(ops.size() * kBytesPorOperacion + kEstados * 4);
+    unsigned char* const fin = buffer.data() + buffer.size();
+    unsigned char* p = fin;
+
+    uint32_t estados[kEstados];
+    std::fill(estados, estados + kEstados, formato::kCotaRANS);
+    for (size_t i = ops.size(); i-- > 0;) {
+        const OperacionRANS& op = ops[i];
+        uint32_t& x = estados[i % kEstados];
+        // Se sacan bytes hasta que, tras codificar, el estado siga en 32 bits.
+        // Sin bucle: se cuentan (a lo sumo 3) y se escriben los 4 bytes bajos;
+        // los que sobran por delante los pisa la operación siguiente.
+        const uint64_t xMaximo = op.xMaximo;
+        const uint32_t n = (x >= xMaximo) + (x >= (xMaximo << 8)) + (x >= (xMaximo << 16));
+        p[-4] = static_cast<unsigned char>(x >> 24);
+        p[-3] = static_cast<unsigned char>(x >> 16);
+        p[-2] = static_cast<unsigned char>(x >> 8);
+        p[-1] = static_cast<unsigned char>(x);
+        p -= n;
+        x >>= 8 * n;
+        // (x / f) * 2^bits + x % f + inicio, con x / f por el recíproco
+        const uint32_t q = static_cast<uint32_t>((uint64_t(x) * op.reciproco) >> 32) >> op.corrimiento;
+        x += op.sesgo + q * op.complemento;
+    }
+    // El decoder lee primero el estado 0
+    for (uint32_t k = kEstados; k-- > 0;) {
+        p -= 4;
+        for (int b = 0; b < 4; ++b) {
+            p[b] = static_cast<unsigned char>(estados[k] >> (8 * b));
+        }
+    }
+    salida.insert(salida.end(), p, fin);
+}
+
+} // namespace huffman
@@ -0,0 +1,137 @@
+#include "huffman/TablaCompartida.hpp"
+#include "huffman/Formato.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace huffman {
+
+namespace {
+
+std::string serializarTabla(const TablaCompartida& tabla) {
+    std::ostringstream out(std::ios::binary);
+    formato::escribirTablaCanonica(out, tabla.simbolos, tabla.longitudes);
+    return out.str();
+}
+
+// Lector de varints sobre los bytes del archivo ya en memoria.
+class LectorBytes {
+public:
+    LectorBytes(const std::string& bytes, size_t pos) : bytes_(bytes), pos_(pos) {}
+
+    uint8_t byte() {
+        if (pos_ >= bytes_.size()) {
+            throw std::runtime_error("Archivo de tablas incompleto.");
+        }
+        return static_cast<uint8_t>(bytes_[pos_++]);
+    }
+    uint64_t varint() {
+        uint64_t valor = 0;
+        for (int desplazamiento = 0; desplazamiento < 64; desplazamiento += 7) {
+            const uint8_t b = byte();
+            valor |= uint64_t(b & 0x7F) << desplazamiento;
+            if ((b & 0x80) == 0) {
+                return valor;
+            }
+        }
+        throw std::runtime_error("Varint inválido en el archivo de tablas.");
+    }
+    uint32_t u32() {
+        uint32_t valor = 0;
+        for (int i = 0; i < 4; ++i) {
+            valor |= uint32_t(byte()) << (8 * i);
+        }
+        return valor;
+    }
+    size_t posicion() const { return pos_; }
+
+private:
+    const std::string& bytes_;
+    size_t pos_;
+};
+
+} // namespace
+
+uint32_t hashTablaCompartida(const TablaCompartida& tabla) {
+    const std::string bytes = serializarTabla(tabla);
+    return formato::hashFNV1a(bytes.data(), bytes.size());
+}
+
+void guardarTablaCompartida(const std::string& ruta, const TablaCompartida& tabla) {
+    std::ofstream out(ruta, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("No se pudo crear el archivo de tablas: " + ruta);
+    }
+    const std::string bytes = serializarTabla(tabla);
+    out.write(formato::kFirmaTablas, sizeof(formato::kFirmaTablas));
+    out.put(static_cast<char>(formato::kVersionTablas));
+    formato::escribirVarint(out, tabla.id);
+    formato::escribirU32(out, formato::hashFNV1a(bytes.data(), bytes.size()));
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Error escribiendo el archivo de tablas: " + ruta);
+    }
+}
+
+TablaCompartida cargarTablaCompartida(const std::string& ruta) {
+    std::ifstream in(ruta, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("No se pudo abrir el archivo de tablas: " + ruta);
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(formato::kFirmaTablas) ||
+        std::memcmp(bytes.data(), formato::kFirmaTablas, sizeof(formato::kFirmaTablas)) != 0) {
+        throw std::runtime_error("El archivo no es un archivo de tablas: " + ruta);
+    }
+    LectorBytes lector(bytes, sizeof(formato::kFirmaTablas));
+    if (lector.byte() != formato::kVersionTablas) {
+        throw std::runtime_error("Versión de archivo de tablas no soportada: " + ruta);
+    }
+    TablaCompartida tabla;
+    const uint64_t id = lector.varint();
+    if (id > UINT32_MAX) {
+        throw std::runtime_error("Id de tabla inválido en " + ruta);
+    }
+    tabla.id = static_cast<uint32_t>(id);
+    tabla.hash = lector.u32();
+    if (formato::hashFNV1a(bytes.data() + lector.posicion(), bytes.size() - lector.posicion()) != tabla.hash) {
+        throw std::runtime_error("El hash no coincide con la tabla en " + ruta);
+    }
+
+    // Tabla canónica: de las cantidades por longitud sale la de cada símbolo
+    const uint64_t numSimbolos = lector.varint();
+    if (numSimbolos == 0 || numSimbolos > 0x110000) {
+        throw std::runtime_error("Tabla vacía o inválida en " + ruta);
+    }
+    tabla.longitudMaxima = lector.byte();
+    if (tabla.longitudMaxima <= 0 || tabla.longitudMaxima > 32) {
+        throw std::runtime_error("Longitud máxima de código inválida en " + ruta);
+    }
+    // Los códigos tienen que caber (Kraft): si no, dos se pisarían
+    uint64_t ocupado = 0;
+    for (int largo = 1; largo <= tabla.longitudMaxima; ++largo) {
+        const uint64_t cantidad = lector.varint();
+        if (cantidad > numSimbolos - tabla.longitudes.size()) {
+            throw std::runtime_error("Tabla inválida en " + ruta);
+        }
+        ocupado += cantidad << (tabla.longitudMaxima - largo);
+        tabla.longitudes.insert(tabla.longitudes.end(), cantidad, static_cast<uint32_t>(largo));
+    }
+    if (tabla.longitudes.size() != numSimbolos || ocupado > (uint64_t(1) << tabla.longitudMaxima)) {
+        throw std::runtime_error("Tabla inválida en " + ruta);
+    }
+    for (uint64_t k = 0; k < numSimbolos; ++k) {
+        const uint64_t cp = lector.varint();
+        if (cp > 0x10FFFF) {
+            throw std::runtime_error("Codepoint fuera de rango en " + ruta);
+        }
+        tabla.simbolos.push_back(static_cast<uint32_t>(cp));
+    }
+    return tabla;
+}
+
+} // namespace huffman
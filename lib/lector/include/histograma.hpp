@@ -0,0 +1,62 @@
+#ifndef HISTOGRAMA_HPP
+#define HISTOGRAMA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Histograma de codepoints compartido por el lector y el compresor.
+//
+// Los codepoints del BMP (< 0x10000) se cuentan en un arreglo plano y los
+// demás, que en texto real son raros, en un hash chico. Al contar un tramo,
+// el rango Latin-1 usa cuatro tablas intercaladas: así una racha del mismo
+// carácter (espacios, fondo) no espera en cada incremento al anterior.
+//
+// Se guardan aparte los codepoints densos con frecuencia > 0: clear(),
+// distintos() y paraCada() solo recorren esos, de modo que una misma
+// instancia sirve para muchos bloques chicos sin pasar por las 65536 entradas.
+class Histograma {
+public:
+    static constexpr uint32_t kLimiteDenso = 0x10000;
+
+    Histograma();
+
+    void contar(const uint32_t* cps, size_t n);
+    void contar(const std::vector<uint32_t>& cps) { contar(cps.data(), cps.size()); }
+    void sumar(uint32_t cp, uint64_t veces = 1);
+    // Olvida un codepoint (p. ej. el 0, que no cuenta para el fondo).
+    void quitar(uint32_t cp);
+    void clear();
+
+    uint64_t frecuencia(uint32_t cp) const;
+    size_t distintos() const;
+    uint64_t total() const { return totalContado; }
+    // Codepoint más frecuente; ante empate, el menor. {0, 0} si está vacío.
+    std::pair<uint32_t, uint64_t> masFrecuente() const;
+
+    // Recorre los codepoints con frecuencia > 0 en orden creciente: f(cp, frecuencia).
+    template <class F>
+    void paraCada(F f) const {
+        std::vector<uint32_t> presentes(tocados);
+        std::sort(presentes.begin(), presentes.end());
+        for (uint32_t cp : presentes) {
+            f(cp, denso[cp]);
+        }
+        std::vector<std::pair<uint32_t, uint64_t>> ordenado(resto.begin(), resto.end());
+        std::sort(ordenado.begin(), ordenado.end());
+        for (const auto& par : ordenado) {
+            f(par.first, par.second);
+        }
+    }
+
+private:
+    std::vector<uint64_t> denso;
+    std::vector<uint32_t> tocados;  // codepoints de 'denso' con frecuencia > 0, sin orden
+    std::unordered_map<uint32_t, uint64_t> resto;
+    uint64_t totalContado = 0;
+};
+
+#endif // HISTOGRAMA_HPP
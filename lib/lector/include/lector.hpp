@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <fstream>
+#include <tuple>
+#include "histograma.hpp"
 
 
 struct UTF_8Text {
@@ -31,14 +34,153 @@ namespace text {
     bool utf8_to_codepoints(const std::string& s, std::vector<uint32_t>& cps);
     void latin1_to_utf8(const std::vector<unsigned char>& bytes, std::string& out);
     bool utf16_to_codepoints(const std::vector<unsigned char>& b, bool big_endian,size_t offset, std::vector<uint32_t>& cps);
+    // Variantes sobre un rango de memoria (p. ej. un ArchivoMapeado), sin copiarlo antes.
+    bool utf8_to_codepoints(const unsigned char* p, size_t n, std::vector<uint32_t>& cps);
+    void latin1_to_utf8(const unsigned char* p, size_t n, std::string& out);
+    bool utf16_to_codepoints(const unsigned char* p, size_t n, bool big_endian, std::vector<uint32_t>& cps);
+    // Decodifica un codepoint UTF-8: devuelve los bytes consumidos, 0 si faltan bytes o -1 si es inválido.
+    int decodificarUTF8(const unsigned char* p, size_t disponibles, uint32_t& cp);
+    // Núcleos vectorizados (lector_simd.cpp): copian a 'out' el tramo inicial que no
+    // necesita decodificación (bytes ASCII, unidades UTF-16 que no son surrogates) y
+    // devuelven cuántos caracteres copiaron. Con pararEnSalto el tramo corta en '\n'.
+    // 'out' debe tener lugar para n (o 'unidades') valores: puede escribir más allá
+    // de lo que devuelve.
+    size_t copiarTramoASCII(const unsigned char* p, size_t n, uint32_t* out, bool pararEnSalto);
+    size_t copiarTramoUTF16(const unsigned char* p, size_t unidades, bool big_endian, uint32_t* out, bool pararEnSalto);
+    size_t copiarTramoASCIIaUTF8(const uint32_t* cps, size_t n, char* out);
+    // Codifica 'n' codepoints a UTF-8 al final de 'out' (tramos ASCII en bloque).
+    void append_utf8(std::string& out, const uint32_t* cps, size_t n);
 
 };
 
+// Archivo de solo lectura proyectado en memoria (mmap) con la pista de acceso
+// secuencial, así los lectores recorren las páginas del page cache sin copias.
+// Si el sistema no permite proyectarlo (otra plataforma, un pipe) y
+// 'copiarSiFalla' es true, se lee completo a un buffer propio.
+class ArchivoMapeado {
+public:
+    explicit ArchivoMapeado(const std::string& ruta, bool copiarSiFalla = true);
+    ~ArchivoMapeado();
+
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+
+    bool abierto() const { return abiertoOk; }
+    bool mapeado() const { return mapa != nullptr; }
+    const unsigned char* datos() const { return inicio; }
+    size_t tamano() const { return tam; }
+
+private:
+    void* mapa = nullptr;
+    const unsigned char* inicio = nullptr;
+    size_t tam = 0;
+    std::vector<unsigned char> copia;
+    bool abiertoOk = false;
+};
+
+// Codificaciones de entrada que reconoce el Normalizer.
+enum class Codificacion { UTF8, UTF16LE, UTF16BE, Latin1 };
+
+// Filas consecutivas de texto en formato compacto: los codepoints de todas las
+// filas van seguidos y la fila i ocupa [inicioFila[i], inicioFila[i + 1]).
+// Es la matriz que pasa del lector al compresor: 4 bytes por celda, sin una
+// asignación por carácter y sin las columnas de relleno, que no se guardan.
+struct BloqueTexto {
+    std::vector<uint32_t> codepoints;
+    std::vector<size_t> inicioFila{0};
+
+    size_t filas() const { return inicioFila.size() - 1; }
+    size_t anchoFila(size_t i) const { return inicioFila[i + 1] - inicioFila[i]; }
+    void clear() { codepoints.clear(); inicioFila.assign(1, 0); }
+};
+
+// Recorre un archivo y lo entrega por filas, sin cargarlo completo: sobre la
+// proyección en memoria si se pudo mapear, o leyendo por trozos si no.
+// Las filas siguen las reglas de almacenarPorLineas (se separan por '\n' y
+// se quita un '\r' final).
+class LectorLineas {
+public:
+    LectorLineas(const std::string& ruta, Codificacion codificacion, size_t offset);
+    // Sobre un stream que no se puede recorrer dos veces (stdin, un pipe): la
+    // codificación sale del BOM (UTF-16 con BOM o, si no, UTF-8) y cada lectura
+    // toma lo que ya llegó en lugar de esperar un trozo entero. Sin BOM, si lo
+    // que llegó al aparecer el primer carácter no ASCII no es UTF-8 válido,
+    // el stream se lee como Latin-1.
+    explicit LectorLineas(std::istream& entrada);
+
+    bool abierto() const { return archivo.mapeado() || in.is_open() || flujo != nullptr; }
+    // Agrega filas completas a 'bloque' hasta sumar 'maxCodepoints' codepoints
+    // o 'maxFilas' filas. Devuelve false si no agregó ninguna (fin o error).
+    // Sobre un stream también corta tras una fila si no queda nada por leer
+    // sin esperar: lo que ya llegó no se retiene hasta que llegue más.
+    bool leerBloque(BloqueTexto& bloque, size_t maxCodepoints, size_t maxFilas);
+    bool huboError() const { return error; }
+    // Cantidad de '\n' y de '\r' finales consumidos hasta ahora.
+    uint64_t saltosDeLinea() const { return saltos; }
+    uint64_t retornosQuitados() const { return retornos; }
+
+private:
+    bool siguienteCodepoint(uint32_t& cp);
+    void copiarTramo(std::vector<uint32_t>& destino);
+    bool rellenar();
+    bool leerDisponible();
+    size_t bytesSiguiente() const;
+    bool datosListos() const;
+
+    ArchivoMapeado archivo;
+    std::ifstream in;
+    std::istream* flujo = nullptr;
+    Codificacion codificacion;
+    std::vector<unsigned char> buffer;
+    const unsigned char* datos = nullptr; // proyección del archivo o 'buffer'
+    size_t pos = 0;
+    size_t fin = 0;
+    bool finArchivo = false;
+    bool terminado = false;
+    bool error = false;
+    bool utf8SinConfirmar = false; // stream sin BOM que todavía puede ser Latin-1
+    uint64_t saltos = 0;
+    uint64_t retornos = 0;
+};
+
+// Medidas de un archivo obtenidas en una pasada en streaming.
+struct PerfilTexto {
+    Codificacion codificacion = Codificacion::UTF8;
+    size_t offset = 0;             // bytes de BOM a saltar
+    size_t filas = 0;
+    size_t columnas = 0;
+    uint32_t masFrecuente = 0;     // fondo: codepoint más frecuente sin contar ceros
+    size_t simbolosDistintos = 0;
+    uint64_t totalCodepoints = 0;
+};
+
+// Arma un PerfilTexto con los bloques que se van leyendo, para quien ya
+// recorre el archivo por otro motivo (la compresión en una pasada).
+class MedidorPerfil {
+public:
+    void agregar(const BloqueTexto& bloque);
+    // Completa filas, columnas, fondo y símbolos de 'perfil' con lo agregado
+    // y los saltos de línea que consumió 'lector'.
+    void terminar(const LectorLineas& lector, PerfilTexto& perfil);
+
+private:
+    Histograma frecuencia;
+    size_t filas = 0;
+    size_t columnas = 0;
+    uint64_t total = 0;
+};
+
 class Normalizer {
 public:
     static UTF_8Text cargar_normalizado_UTF8(const std::string& ruta);
-    static std::tuple<int, int, std::vector<std::vector<int>>> CrearEntregarMatriz(UTF_8Text data);
     static void mostrarLetrasYPosiciones(UTF_8Text data);
+    // Detecta la codificación (mismas reglas que cargar_normalizado_UTF8) y mide
+    // filas, columnas y fondo leyendo por trozos. false si no se pudo decodificar.
+    static bool perfilarArchivo(const std::string& ruta, PerfilTexto& perfil);
+    // Solo la codificación que indica el BOM (sin BOM, UTF-8), lo primero que
+    // hace perfilarArchivo. Si el texto no resulta UTF-8 válido, es Latin-1.
+    // false si no se pudo abrir o está vacío.
+    static bool detectarCodificacion(const std::string& ruta, PerfilTexto& perfil);
 };
 
 #endif
\ No newline at end of file
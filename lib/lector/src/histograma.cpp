@@ -0,0 +1,119 @@
+#include "histograma.hpp"
+#include <cstring>
+
+// ========== HISTOGRAMA DE CODEPOINTS ==========
+
+namespace {
+
+// Tramo máximo contado con los contadores locales de 32 bits.
+constexpr size_t kTramoLocal = size_t(1) << 30;
+
+constexpr uint32_t kTablasIntercaladas = 4;
+constexpr uint32_t kRangoIntercalado = 256;
+
+} // namespace
+
+Histograma::Histograma() : denso(kLimiteDenso, 0) {}
+
+void Histograma::contar(const uint32_t* cps, size_t n) {
+    uint32_t locales[kTablasIntercaladas][kRangoIntercalado];
+    for (size_t base = 0; base < n; base += kTramoLocal) {
+        const size_t fin = std::min(n, base + kTramoLocal);
+        std::memset(locales, 0, sizeof(locales));
+
+        auto contarUno = [this](uint32_t* tabla, uint32_t cp) {
+            if (cp < kRangoIntercalado) {
+                ++tabla[cp];
+            } else if (cp < kLimiteDenso) {
+                if (denso[cp]++ == 0) {
+                    tocados.push_back(cp);
+                }
+            } else {
+                ++resto[cp];
+            }
+        };
+
+        size_t i = base;
+        for (; i + kTablasIntercaladas <= fin; i += kTablasIntercaladas) {
+            contarUno(locales[0], cps[i]);
+            contarUno(locales[1], cps[i + 1]);
+            contarUno(locales[2], cps[i + 2]);
+            contarUno(locales[3], cps[i + 3]);
+        }
+        for (; i < fin; ++i) {
+            contarUno(locales[0], cps[i]);
+        }
+
+        for (uint32_t cp = 0; cp < kRangoIntercalado; ++cp) {
+            const uint64_t veces =
+                static_cast<uint64_t>(locales[0][cp]) + locales[1][cp] + locales[2][cp] + locales[3][cp];
+            if (veces != 0 && denso[cp] == 0) {
+                tocados.push_back(cp);
+            }
+            denso[cp] += veces;
+        }
+    }
+    totalContado += n;
+}
+
+void Histograma::sumar(uint32_t cp, uint64_t veces) {
+    if (veces == 0) {
+        return;
+    }
+    if (cp < kLimiteDenso) {
+        if (denso[cp] == 0) {
+            tocados.push_back(cp);
+        }
+        denso[cp] += veces;
+    } else {
+        resto[cp] += veces;
+    }
+    totalContado += veces;
+}
+
+void Histograma::quitar(uint32_t cp) {
+    if (cp < kLimiteDenso) {
+        if (denso[cp] != 0) {
+            totalContado -= denso[cp];
+            denso[cp] = 0;
+            tocados.erase(std::find(tocados.begin(), tocados.end(), cp));
+        }
+        return;
+    }
+    auto it = resto.find(cp);
+    if (it != resto.end()) {
+        totalContado -= it->second;
+        resto.erase(it);
+    }
+}
+
+void Histograma::clear() {
+    for (uint32_t cp : tocados) {
+        denso[cp] = 0;
+    }
+    tocados.clear();
+    resto.clear();
+    totalContado = 0;
+}
+
+uint64_t Histograma::frecuencia(uint32_t cp) const {
+    if (cp < kLimiteDenso) {
+        return denso[cp];
+    }
+    auto it = resto.find(cp);
+    return it != resto.end() ? it->second : 0;
+}
+
+size_t Histograma::distintos() const {
+    return tocados.size() + resto.size();
+}
+
+std::pair<uint32_t, uint64_t> Histograma::masFrecuente() const {
+    std::pair<uint32_t, uint64_t> mejor{0, 0};
+    paraCada([&mejor](uint32_t cp, uint64_t f) {
+        if (f > mejor.second) {
+            mejor = {cp, f};
+        }
+    });
+    return mejor;
+}
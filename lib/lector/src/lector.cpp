@@ -1,4 +1,5 @@
 #include "lector.hpp"
+#include "histograma.hpp"
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -19,25 +20,19 @@
  * @return Vector con todos los bytes del archivo, o vector vacío si hay error
  */
 std::vector<unsigned char> text::leerBytes(const std::string& ruta) {
-    // Abrir archivo en modo binario
-    std::ifstream f(ruta, std::ios::binary);
-    if (!f) {
+    // Proyectar el archivo y copiarlo de una vez (no byte a byte)
+    ArchivoMapeado archivo(ruta);
+    if (!archivo.abierto()) {
         std::cerr << "No se pudo abrir el archivo: " << ruta << "\n";
         return {};
     }
     
-    // Verificar tamaño del archivo moviendo el puntero al final
-    f.seekg(0, std::ios::end);
-    std::streamsize size = f.tellg();
-    f.seekg(0, std::ios::beg);
-    
-    if (size == 0) {
+    if (archivo.tamano() == 0) {
         std::cerr << "Archivo vacío: " << ruta << "\n";
         return {};
     }
     
-    // Leer todos los bytes usando iteradores
-    return { std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>() };
+    return { archivo.datos(), archivo.datos() + archivo.tamano() };
 }
 
 /** Almacenamiento de texto por lineas */
@@ -142,6 +137,62 @@ void text::push_utf8(std::string& out, uint32_t cp) {
     }
 }
 
+/**
+ * Decodifica un único codepoint UTF-8 al inicio de 'p'
+ * @param p: Bytes de entrada
+ * @param disponibles: Cuántos bytes se pueden leer desde 'p'
+ * @param cp: Punto de código resultante
+ * @return Bytes consumidos (1-4), 0 si la secuencia está incompleta o -1 si es inválida
+ */
+int text::decodificarUTF8(const unsigned char* p, size_t disponibles, uint32_t& cp) {
+    unsigned char c = p[0];
+    size_t extra = 0; // Número de bytes adicionales esperados
+
+    // Determinar el patrón del primer byte y cuántos bytes adicionales esperar
+    if (c <= 0x7F) {
+        // ASCII - 1 byte
+        cp = c;
+        return 1;
+    } else if ((c & 0xE0) == 0xC0) {
+        // 2 bytes - patrón: 110xxxxx
+        cp = c & 0x1F;
+        extra = 1;
+        if (cp < 0x02) return -1; // Detectar "overlong encoding"
+    } else if ((c & 0xF0) == 0xE0) {
+        // 3 bytes - patrón: 1110xxxx
+        cp = c & 0x0F;
+        extra = 2;
+    } else if ((c & 0xF8) == 0xF0) {
+        // 4 bytes - patrón: 11110xxx
+        cp = c & 0x07;
+        extra = 3;
+        if (cp > 0x04) return -1; // Fuera de rango Unicode
+    } else {
+        return -1; // Byte inicial inválido
+    }
+
+    // Verificar que hay suficientes bytes disponibles
+    if (extra >= disponibles) return 0;
+
+    // Procesar bytes de continuación (deben tener patrón 10xxxxxx)
+    for (size_t j = 1; j <= extra; ++j) {
+        unsigned char cc = p[j];
+        if ((cc & 0xC0) != 0x80) return -1; // Byte de continuación inválido
+        cp = (cp << 6) | (cc & 0x3F);
+    }
+
+    // Validaciones de seguridad Unicode
+    if (cp >= 0xD800 && cp <= 0xDFFF) return -1; // Surrogates no permitidos en UTF-8
+    if (cp > 0x10FFFF) return -1; // Fuera de rango Unicode máximo
+
+    // Detectar "overlong encoding" (usar más bytes de los necesarios)
+    if (extra == 1 && cp < 0x80) return -1;
+    if (extra == 2 && cp < 0x800) return -1;
+    if (extra == 3 && cp < 0x10000) return -1;
+
+    return static_cast<int>(1 + extra);
+}
+
 /**
  * Decodifica una cadena UTF-8 y extrae los puntos de código Unicode individuales
  * @param s: Cadena en formato UTF-8
@@ -149,59 +200,33 @@ void text::push_utf8(std::string& out, uint32_t cp) {
  * @return true si la decodificación fue exitosa, false si hay errores
  */
 bool text::utf8_to_codepoints(const std::string& s, std::vector<uint32_t>& cps) {
-    cps.clear();
-    size_t i = 0, n = s.size();
+    return utf8_to_codepoints(reinterpret_cast<const unsigned char*>(s.data()), s.size(), cps);
+}
+
+bool text::utf8_to_codepoints(const unsigned char* p, size_t n, std::vector<uint32_t>& cps) {
+    cps.resize(n); // Nunca hay más codepoints que bytes
+    uint32_t* out = cps.data();
+    size_t i = 0, k = 0;
     
     while (i < n) {
-        unsigned char c = static_cast<unsigned char>(s[i]);
-        uint32_t cp = 0;
-        size_t extra = 0; // Número de bytes adicionales esperados
-
-        // Determinar el patrón del primer byte y cuántos bytes adicionales esperar
-        if (c <= 0x7F) {
-            // ASCII - 1 byte
-            cp = c;
-            extra = 0;
-        } else if ((c & 0xE0) == 0xC0) {
-            // 2 bytes - patrón: 110xxxxx
-            cp = c & 0x1F;
-            extra = 1;
-            if (cp < 0x02) return false; // Detectar "overlong encoding"
-        } else if ((c & 0xF0) == 0xE0) {
-            // 3 bytes - patrón: 1110xxxx
-            cp = c & 0x0F;
-            extra = 2;
-        } else if ((c & 0xF8) == 0xF0) {
-            // 4 bytes - patrón: 11110xxx
-            cp = c & 0x07;
-            extra = 3;
-            if (cp > 0x04) return false; // Fuera de rango Unicode
-        } else {
-            return false; // Byte inicial inválido
-        }
+        // Los tramos ASCII se copian en bloque, sin pasar por el decodificador
+        size_t ascii = copiarTramoASCII(p + i, n - i, out + k, /*pararEnSalto=*/false);
+        i += ascii;
+        k += ascii;
+        if (i == n) break;
 
-        // Verificar que hay suficientes bytes en la cadena
-        if (i + extra >= n) return false;
-        
-        // Procesar bytes de continuación (deben tener patrón 10xxxxxx)
-        for (size_t j = 1; j <= extra; ++j) {
-            unsigned char cc = static_cast<unsigned char>(s[i + j]);
-            if ((cc & 0xC0) != 0x80) return false; // Byte de continuación inválido
-            cp = (cp << 6) | (cc & 0x3F);
+        uint32_t cp = 0;
+        // Una secuencia incompleta al final de la cadena también es un error
+        int usados = decodificarUTF8(p + i, n - i, cp);
+        if (usados <= 0) {
+            cps.clear();
+            return false;
         }
 
-        // Validaciones de seguridad Unicode
-        if (cp >= 0xD800 && cp <= 0xDFFF) return false; // Surrogates no permitidos en UTF-8
-        if (cp > 0x10FFFF) return false; // Fuera de rango Unicode máximo
-        
-        // Detectar "overlong encoding" (usar más bytes de los necesarios)
-        if (extra == 1 && cp < 0x80) return false;
-        if (extra == 2 && cp < 0x800) return false;
-        if (extra == 3 && cp < 0x10000) return false;
-
-        cps.push_back(cp);
-        i += 1 + extra; // Avanzar al siguiente caracter
+        out[k++] = cp;
+        i += static_cast<size_t>(usados); // Avanzar al siguiente caracter
     }
+    cps.resize(k);
     return true;
 }
 
@@ -210,10 +235,15 @@ bool text::utf8_to_codepoints(const std::string& s, std::vector<uint32_t>& cps)
  * Latin-1 usa 1 byte por caracter y cubre los caracteres europeos occidentales
  */
 void text::latin1_to_utf8(const std::vector<unsigned char>& bytes, std::string& out) {
+    latin1_to_utf8(bytes.data(), bytes.size(), out);
+}
+
+void text::latin1_to_utf8(const unsigned char* p, size_t n, std::string& out) {
     out.clear();
-    out.reserve(bytes.size() * 2); // Reservar espacio para posible expansión
+    out.reserve(n * 2); // Reservar espacio para posible expansión
     
-    for (unsigned char b : bytes) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char b = p[i];
         if (b < 0x80) {
             // Caracteres ASCII (0-127) permanecen igual
             out.push_back(static_cast<char>(b));
@@ -237,12 +267,26 @@ void text::latin1_to_utf8(const std::vector<unsigned char>& bytes, std::string&
  */
 bool text::utf16_to_codepoints(const std::vector<unsigned char>& b, bool big_endian,
                                 size_t offset, std::vector<uint32_t>& cps) {
+    if (offset > b.size()) return false;
+    return utf16_to_codepoints(b.data() + offset, b.size() - offset, big_endian, cps);
+}
+
+bool text::utf16_to_codepoints(const unsigned char* b, size_t n, bool big_endian, std::vector<uint32_t>& cps) {
     cps.clear();
     
     // UTF-16 siempre usa pares de bytes, verificar que la longitud sea par
-    if ((b.size() - offset) % 2 != 0) return false;
+    if (n % 2 != 0) return false;
+    cps.resize(n / 2); // Nunca hay más codepoints que unidades
+    uint32_t* out = cps.data();
+    size_t k = 0;
     
-    for (size_t i = offset; i + 1 < b.size(); i += 2) {
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        // Tramo sin surrogates: cada unidad es directamente su codepoint
+        size_t copiadas = copiarTramoUTF16(b + i, (n - i) / 2, big_endian, out + k, /*pararEnSalto=*/false);
+        k += copiadas;
+        i += 2 * copiadas;
+        if (i + 1 >= n) break;
+
         // Leer un código de 16 bits (2 bytes) considerando el endianness
         uint16_t u = big_endian 
             ? (static_cast<uint16_t>(b[i]) << 8 | static_cast<uint16_t>(b[i+1]))
@@ -250,27 +294,29 @@ bool text::utf16_to_codepoints(const std::vector<unsigned char>& b, bool big_end
             
         if (u >= 0xD800 && u <= 0xDBFF) {
             // High surrogate - necesita un low surrogate para formar un caracter especial
-            if (i + 3 >= b.size()) return false; // Verificar que hay bytes suficientes
+            if (i + 3 >= n) { cps.clear(); return false; } // Verificar que hay bytes suficientes
             
             // Leer el low surrogate
             uint16_t v = big_endian
                 ? (static_cast<uint16_t>(b[i+2]) << 8 | static_cast<uint16_t>(b[i+3]))
                 : (static_cast<uint16_t>(b[i+3]) << 8 | static_cast<uint16_t>(b[i+2]));
                 
-            if (v < 0xDC00 || v > 0xDFFF) return false; // Low surrogate inválido
+            if (v < 0xDC00 || v > 0xDFFF) { cps.clear(); return false; } // Low surrogate inválido
             
             // Calcular el punto de código completo a partir del par de surrogates
             // Fórmula: 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00)
             uint32_t cp = 0x10000 + (((u - 0xD800) << 10) | (v - 0xDC00));
-            cps.push_back(cp);
+            out[k++] = cp;
             i += 2; // Saltar el low surrogate que ya procesamos
         } else if (u >= 0xDC00 && u <= 0xDFFF) {
+            cps.clear();
             return false; // Low surrogate sin high surrogate - error
         } else {
             // Caracter básico de 16 bits (sin surrogate)
-            cps.push_back(u);
+            out[k++] = u;
         }
     }
+    cps.resize(k);
     return true;
 }
 
@@ -280,23 +326,13 @@ std::pair<uint32_t, int> UTF_8Text::analizarFrecuencia(const std::vector<uint32_
         return {0, 0}; // Vector vacío
     }
     
-    std::map<uint32_t, int> frecuencia;
-    
     // Contar frecuencia de cada codepoint
-    for (uint32_t cp : codepoints) {
-        frecuencia[cp]++;
-    }
+    Histograma frecuencia;
+    frecuencia.contar(codepoints);
     
-    // Encontrar el elemento con máxima frecuencia
-    auto max_element = std::max_element(
-        frecuencia.begin(), 
-        frecuencia.end(),
-        [](const auto& a, const auto& b) { 
-            return a.second < b.second; 
-        }
-    );
-    
-    return *max_element;
+    // Elemento con máxima frecuencia; ante empate, el menor codepoint
+    auto max_element = frecuencia.masFrecuente();
+    return {max_element.first, static_cast<int>(max_element.second)};
 }
 
 /**
@@ -342,19 +378,28 @@ UTF_8Text Normalizer::cargar_normalizado_UTF8(const std::string& ruta) {
     UTF_8Text out;
     
     try {
-        // 1. Leer todos los bytes del archivo
-        auto bytes = text::leerBytes(ruta);
-        if (bytes.empty()) {
-            return out; // Archivo vacío o error de lectura
+        // 1. Proyectar el archivo en memoria: los decodificadores leen
+        // directamente de las páginas del archivo, sin copias intermedias
+        ArchivoMapeado archivo(ruta);
+        if (!archivo.abierto()) {
+            std::cerr << "No se pudo abrir el archivo: " << ruta << "\n";
+            return out;
+        }
+        if (archivo.tamano() == 0) {
+            std::cerr << "Archivo vacío: " << ruta << "\n";
+            return out;
         }
+        const unsigned char* bytes = archivo.datos();
+        const size_t n = archivo.tamano();
+        const std::vector<unsigned char> inicio(bytes, bytes + std::min<size_t>(n, 3));
 
         // 2. PRIMERO: Detectar y procesar UTF-16 con BOM
         // Los BOM de UTF-16 son muy específicos y fáciles de detectar
-        if (text::tieneBOM_UTF16LE(bytes) || text::tieneBOM_UTF16BE(bytes)) {
-            bool be = text::tieneBOM_UTF16BE(bytes); // Determinar endianness
+        if (text::tieneBOM_UTF16LE(inicio) || text::tieneBOM_UTF16BE(inicio)) {
+            bool be = text::tieneBOM_UTF16BE(inicio); // Determinar endianness
             std::vector<uint32_t> cps;
 
-            if (!text::utf16_to_codepoints(bytes, be, /*offset=*/2, cps)) {
+            if (!text::utf16_to_codepoints(bytes + 2, n - 2, be, cps)) {
                 std::cerr << "Error decodificando UTF-16 en: " << ruta << "\n";
                 return out;
             }
@@ -362,35 +407,27 @@ UTF_8Text Normalizer::cargar_normalizado_UTF8(const std::string& ruta) {
             out.codepoints = std::move(cps);
             // Reconstruir string UTF-8 desde los puntos de código
             out.utf8.reserve(out.codepoints.size() * 4); // Reservar espacio máximo
-            for (uint32_t cp : out.codepoints) {
-                text::push_utf8(out.utf8, cp);
-            }
+            text::append_utf8(out.utf8, out.codepoints.data(), out.codepoints.size());
             return out;
         }
 
         // 3. SEGUNDO: Intentar como UTF-8 (con o sin BOM)
-        size_t offset = text::tieneBOM_UTF8(bytes) ? 3 : 0;
-        std::string as_utf8(bytes.begin() + offset, bytes.end());
+        size_t offset = text::tieneBOM_UTF8(inicio) ? 3 : 0;
         std::vector<uint32_t> cps;
+        cps.reserve(n - offset); // Nunca hay más codepoints que bytes
         
-        // Intentar decodificar como UTF-8 válido
-        if (text::utf8_to_codepoints(as_utf8, cps)) {
-            out.utf8 = std::move(as_utf8);
+        // Intentar decodificar como UTF-8 válido; solo entonces se copia el texto
+        if (text::utf8_to_codepoints(bytes + offset, n - offset, cps)) {
+            out.utf8.assign(reinterpret_cast<const char*>(bytes + offset), n - offset);
             out.codepoints = std::move(cps);
             return out;
         }
 
         // 4. TERCERO: Fallback a Latin-1 (compatibilidad con texto europeo antiguo)
-        std::string utf8_from_l1;
-        text::latin1_to_utf8(bytes, utf8_from_l1);
-        if (text::utf8_to_codepoints(utf8_from_l1, cps)) {
-            out.utf8 = std::move(utf8_from_l1);
-            out.codepoints = std::move(cps);
-            return out;
-        }
-
-        std::cerr << "No se pudo determinar la codificación del archivo: " << ruta << "\n";
-        
+        // Cada byte es su propio codepoint, no hace falta volver a decodificar
+        text::latin1_to_utf8(bytes, n, out.utf8);
+        out.codepoints.assign(bytes, bytes + n);
+        return out;
     } catch (const std::exception& e) {
         std::cerr << "Excepción al procesar " << ruta << ": " << e.what() << "\n";
     }
@@ -398,32 +435,3 @@ UTF_8Text Normalizer::cargar_normalizado_UTF8(const std::string& ruta) {
     
     return out;
 }
-std::tuple<int, int, std::vector<std::vector<int>>> Normalizer::CrearEntregarMatriz(UTF_8Text data) {
-    std::vector<std::vector<int>> matriz;
-    auto lineas = text::almacenarPorLineas(data);
-    auto [filas, columnas] = text::determinarDimensionesMatrizUnicode(lineas);
-    auto MasFrecuente = data.analizarFrecuenciaSimplificada(data.codepoints);
-    
-    if (lineas.empty()) {
-        return {0, 0, matriz};
-    }
-    
-    for (size_t i = 0; i < lineas.size(); ++i) {
-        std::vector<uint32_t> cps_linea;
-        if (text::utf8_to_codepoints(lineas[i], cps_linea)) {
-            for (size_t j = 0; j < cps_linea.size(); ++j) {
-                uint32_t cp = cps_linea[j];
-                // Solo agregar si no es cero y no es el más frecuente
-                if (cp != 0 && cp != MasFrecuente.first) {
-                    matriz.push_back({
-                        static_cast<int>(i), 
-                        static_cast<int>(j), 
-                        static_cast<int>(cp)
-                    });
-                }
-            }
-        }
-    }
-
-    return  std::make_tuple(filas, columnas, matriz);
-}
@@ -0,0 +1,65 @@
+#include "lector.hpp"
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LECTOR_USA_MMAP 1
+#endif
+
+// ========== ARCHIVO PROYECTADO EN MEMORIA ==========
+
+ArchivoMapeado::ArchivoMapeado(const std::string& ruta, bool copiarSiFalla) {
+#ifdef LECTOR_USA_MMAP
+    int fd = ::open(ruta.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            abiertoOk = true;
+            tam = static_cast<size_t>(st.st_size);
+            if (tam > 0) {
+                void* p = ::mmap(nullptr, tam, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    // Se recorre de principio a fin: lectura anticipada agresiva
+                    // y las páginas ya leídas pueden salir primero del cache
+                    ::madvise(p, tam, MADV_SEQUENTIAL);
+                    mapa = p;
+                    inicio = static_cast<const unsigned char*>(p);
+                } else {
+                    abiertoOk = false;
+                    tam = 0;
+                }
+            }
+        }
+        ::close(fd);
+    }
+    if (abiertoOk || !copiarSiFalla) {
+        return;
+    }
+#else
+    if (!copiarSiFalla) {
+        return;
+    }
+#endif
+
+    // Sin mmap: una única lectura al buffer propio
+    std::ifstream f(ruta, std::ios::binary);
+    if (!f) {
+        return;
+    }
+    copia.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    inicio = copia.data();
+    tam = copia.size();
+    abiertoOk = true;
+}
+
+ArchivoMapeado::~ArchivoMapeado() {
+#ifdef LECTOR_USA_MMAP
+    if (mapa != nullptr) {
+        ::munmap(mapa, tam);
+    }
+#endif
+}
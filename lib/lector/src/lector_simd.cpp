@@ -0,0 +1,258 @@
+#include "lector.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define LECTOR_X86 1
+#endif
+
+// ========== NÚCLEOS VECTORIZADOS DE TRANSCODIFICACIÓN ==========
+//
+// Casi todo el texto de entrada es ASCII con algún acento suelto, así que en
+// lugar de decodificar carácter por carácter se copian de una vez los tramos
+// que no necesitan decodificación (16 o 32 bytes por paso) y solo lo demás
+// pasa por el decodificador escalar. SSE2 es parte de x86-64; AVX2 se elige
+// en tiempo de ejecución si la CPU lo soporta.
+
+namespace {
+
+// ---------- Versiones escalares (cualquier plataforma) ----------
+
+size_t tramoASCIIEscalar(const unsigned char* p, size_t n, uint32_t* out, bool pararEnSalto) {
+    const uint64_t altos = 0x8080808080808080ULL;
+    const uint64_t unos = 0x0101010101010101ULL;
+    const uint64_t saltos = 0x0A0A0A0A0A0A0A0AULL;
+    size_t i = 0;
+    // De a 8 bytes: sin bit alto y (si hace falta) sin ningún byte igual a '\n'
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        uint64_t malos = w & altos;
+        if (pararEnSalto) {
+            uint64_t x = w ^ saltos;
+            malos |= (x - unos) & ~x & altos;
+        }
+        if (malos != 0) {
+            break;
+        }
+        for (size_t j = 0; j < 8; ++j) {
+            out[i + j] = p[i + j];
+        }
+    }
+    for (; i < n; ++i) {
+        if (p[i] >= 0x80 || (pararEnSalto && p[i] == '\n')) {
+            break;
+        }
+        out[i] = p[i];
+    }
+    return i;
+}
+
+inline uint32_t unidadUTF16(const unsigned char* q, bool be) {
+    return be ? static_cast<uint32_t>(q[0] << 8 | q[1])
+              : static_cast<uint32_t>(q[1] << 8 | q[0]);
+}
+
+size_t tramoUTF16Escalar(const unsigned char* p, size_t unidades, bool be, uint32_t* out, bool pararEnSalto) {
+    size_t i = 0;
+    for (; i < unidades; ++i) {
+        uint32_t u = unidadUTF16(p + 2 * i, be);
+        if ((u & 0xF800) == 0xD800 || (pararEnSalto && u == '\n')) {
+            break;
+        }
+        out[i] = u;
+    }
+    return i;
+}
+
+size_t tramoASCIIaUTF8Escalar(const uint32_t* cps, size_t n, char* out) {
+    size_t i = 0;
+    for (; i < n && cps[i] < 0x80; ++i) {
+        out[i] = static_cast<char>(cps[i]);
+    }
+    return i;
+}
+
+#ifdef LECTOR_X86
+
+// ---------- SSE2 (16 bytes por paso) ----------
+
+size_t tramoASCIISSE2(const unsigned char* p, size_t n, uint32_t* out, bool pararEnSalto) {
+    const __m128i cero = _mm_setzero_si128();
+    const __m128i salto = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        int malos = _mm_movemask_epi8(v);
+        if (pararEnSalto) {
+            malos |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, salto));
+        }
+        // Ensanchar 16 bytes a 16 enteros de 32 bits. Se escriben aunque el
+        // tramo corte antes: lo que sobra lo pisa quien siga escribiendo.
+        __m128i bajo = _mm_unpacklo_epi8(v, cero);
+        __m128i alto = _mm_unpackhi_epi8(v, cero);
+        __m128i* destino = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(destino + 0, _mm_unpacklo_epi16(bajo, cero));
+        _mm_storeu_si128(destino + 1, _mm_unpackhi_epi16(bajo, cero));
+        _mm_storeu_si128(destino + 2, _mm_unpacklo_epi16(alto, cero));
+        _mm_storeu_si128(destino + 3, _mm_unpackhi_epi16(alto, cero));
+        if (malos != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(malos)));
+        }
+    }
+    return i + tramoASCIIEscalar(p + i, n - i, out + i, pararEnSalto);
+}
+
+size_t tramoUTF16SSE2(const unsigned char* p, size_t unidades, bool be, uint32_t* out, bool pararEnSalto) {
+    const __m128i cero = _mm_setzero_si128();
+    const __m128i mascara = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i salto = _mm_set1_epi16('\n');
+    size_t i = 0;
+    for (; i + 8 <= unidades; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2 * i));
+        if (be) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        __m128i malos = _mm_cmpeq_epi16(_mm_and_si128(v, mascara), surrogate);
+        if (pararEnSalto) {
+            malos = _mm_or_si128(malos, _mm_cmpeq_epi16(v, salto));
+        }
+        __m128i* destino = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(destino + 0, _mm_unpacklo_epi16(v, cero));
+        _mm_storeu_si128(destino + 1, _mm_unpackhi_epi16(v, cero));
+        unsigned corte = static_cast<unsigned>(_mm_movemask_epi8(malos));
+        if (corte != 0) {
+            return i + __builtin_ctz(corte) / 2;
+        }
+    }
+    return i + tramoUTF16Escalar(p + 2 * i, unidades - i, be, out + i, pararEnSalto);
+}
+
+size_t tramoASCIIaUTF8SSE2(const uint32_t* cps, size_t n, char* out) {
+    const __m128i noASCII = _mm_set1_epi32(~0x7F);
+    const __m128i cero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i* q = reinterpret_cast<const __m128i*>(cps + i);
+        __m128i a = _mm_loadu_si128(q + 0);
+        __m128i b = _mm_loadu_si128(q + 1);
+        __m128i c = _mm_loadu_si128(q + 2);
+        __m128i d = _mm_loadu_si128(q + 3);
+        __m128i todos = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(todos, noASCII), cero)) != 0xFFFF) {
+            break;
+        }
+        // Todos < 0x80: la saturación del empaquetado no altera ningún valor
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bytes);
+    }
+    return i + tramoASCIIaUTF8Escalar(cps + i, n - i, out + i);
+}
+
+// ---------- AVX2 (32 bytes por paso) ----------
+
+__attribute__((target("avx2")))
+size_t tramoASCIIAVX2(const unsigned char* p, size_t n, uint32_t* out, bool pararEnSalto) {
+    const __m256i salto = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        unsigned malos = static_cast<unsigned>(_mm256_movemask_epi8(v));
+        if (pararEnSalto) {
+            malos |= static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, salto)));
+        }
+        __m128i bajo = _mm256_castsi256_si128(v);
+        __m128i alto = _mm256_extracti128_si256(v, 1);
+        __m256i* destino = reinterpret_cast<__m256i*>(out + i);
+        _mm256_storeu_si256(destino + 0, _mm256_cvtepu8_epi32(bajo));
+        _mm256_storeu_si256(destino + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(bajo, 8)));
+        _mm256_storeu_si256(destino + 2, _mm256_cvtepu8_epi32(alto));
+        _mm256_storeu_si256(destino + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(alto, 8)));
+        if (malos != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(malos));
+        }
+    }
+    return i + tramoASCIISSE2(p + i, n - i, out + i, pararEnSalto);
+}
+
+__attribute__((target("avx2")))
+size_t tramoUTF16AVX2(const unsigned char* p, size_t unidades, bool be, uint32_t* out, bool pararEnSalto) {
+    const __m256i mascara = _mm256_set1_epi16(static_cast<short>(0xF800));
+    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+    const __m256i salto = _mm256_set1_epi16('\n');
+    size_t i = 0;
+    for (; i + 16 <= unidades; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 2 * i));
+        if (be) {
+            v = _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+        }
+        __m256i malos = _mm256_cmpeq_epi16(_mm256_and_si256(v, mascara), surrogate);
+        if (pararEnSalto) {
+            malos = _mm256_or_si256(malos, _mm256_cmpeq_epi16(v, salto));
+        }
+        __m256i* destino = reinterpret_cast<__m256i*>(out + i);
+        _mm256_storeu_si256(destino + 0, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256(destino + 1, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+        unsigned corte = static_cast<unsigned>(_mm256_movemask_epi8(malos));
+        if (corte != 0) {
+            return i + __builtin_ctz(corte) / 2;
+        }
+    }
+    return i + tramoUTF16SSE2(p + 2 * i, unidades - i, be, out + i, pararEnSalto);
+}
+
+bool tieneAVX2() {
+    static const bool soporta = __builtin_cpu_supports("avx2");
+    return soporta;
+}
+
+#endif // LECTOR_X86
+
+} // namespace
+
+size_t text::copiarTramoASCII(const unsigned char* p, size_t n, uint32_t* out, bool pararEnSalto) {
+#ifdef LECTOR_X86
+    return tieneAVX2() ? tramoASCIIAVX2(p, n, out, pararEnSalto)
+                       : tramoASCIISSE2(p, n, out, pararEnSalto);
+#else
+    return tramoASCIIEscalar(p, n, out, pararEnSalto);
+#endif
+}
+
+size_t text::copiarTramoUTF16(const unsigned char* p, size_t unidades, bool big_endian,
+                              uint32_t* out, bool pararEnSalto) {
+#ifdef LECTOR_X86
+    return tieneAVX2() ? tramoUTF16AVX2(p, unidades, big_endian, out, pararEnSalto)
+                       : tramoUTF16SSE2(p, unidades, big_endian, out, pararEnSalto);
+#else
+    return tramoUTF16Escalar(p, unidades, big_endian, out, pararEnSalto);
+#endif
+}
+
+size_t text::copiarTramoASCIIaUTF8(const uint32_t* cps, size_t n, char* out) {
+#ifdef LECTOR_X86
+    return tramoASCIIaUTF8SSE2(cps, n, out);
+#else
+    return tramoASCIIaUTF8Escalar(cps, n, out);
+#endif
+}
+
+/**
+ * Codifica una secuencia de codepoints a UTF-8 al final de 'out'
+ * Los tramos ASCII se copian en bloque; el resto pasa por push_utf8
+ */
+void text::append_utf8(std::string& out, const uint32_t* cps, size_t n) {
+    char tramo[256];
+    size_t i = 0;
+    while (i < n) {
+        size_t pedir = std::min<size_t>(n - i, sizeof(tramo));
+        size_t copiados = copiarTramoASCIIaUTF8(cps + i, pedir, tramo);
+        out.append(tramo, copiados);
+        i += copiados;
+        if (copiados < pedir) {
+            push_utf8(out, cps[i++]);
+        }
+    }
+}
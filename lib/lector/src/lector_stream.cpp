@@ -0,0 +1,456 @@
+#include "lector.hpp"
+#include "histograma.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+// ========== LECTURA DE LÍNEAS EN STREAMING ==========
+
+namespace {
+
+// Tamaño de cada lectura del archivo. Un codepoint nunca ocupa más de 4 bytes,
+// así que basta con conservar ese margen entre una lectura y la siguiente.
+constexpr size_t kTamTrozo = size_t(1) << 16;
+constexpr size_t kMargen = 4;
+
+// Si [p, p + n) es UTF-8 válido. Sin 'completo' todavía pueden llegar más
+// bytes, así que una secuencia cortada al final no cuenta como error.
+bool esUTF8(const unsigned char* p, size_t n, bool completo) {
+    size_t i = 0;
+    while (i < n) {
+        uint32_t cp = 0;
+        int usados = text::decodificarUTF8(p + i, n - i, cp);
+        if (usados < 0 || (usados == 0 && completo)) {
+            return false;
+        }
+        if (usados == 0) {
+            for (size_t k = i + 1; k < n; ++k) {
+                if ((p[k] & 0xC0) != 0x80) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        i += static_cast<size_t>(usados);
+    }
+    return true;
+}
+
+} // namespace
+
+LectorLineas::LectorLineas(const std::string& ruta, Codificacion codificacion, size_t offset)
+    : archivo(ruta, /*copiarSiFalla=*/false), codificacion(codificacion)
+{
+    if (archivo.mapeado()) {
+        // Todo el archivo ya está a la vista: no hay nada que rellenar
+        datos = archivo.datos();
+        fin = archivo.tamano();
+        pos = std::min(offset, fin);
+        finArchivo = true;
+        return;
+    }
+    buffer.resize(kTamTrozo + kMargen);
+    datos = buffer.data();
+    in.open(ruta, std::ios::binary);
+    if (in) {
+        in.ignore(static_cast<std::streamsize>(offset)); // también sirve para pipes
+    }
+}
+
+LectorLineas::LectorLineas(std::istream& entrada)
+    : archivo(std::string(), /*copiarSiFalla=*/false), flujo(&entrada), codificacion(Codificacion::UTF8)
+{
+    buffer.resize(kTamTrozo + kMargen);
+    datos = buffer.data();
+    // Lo justo para ver el BOM: si el primer byte no puede abrir uno no se
+    // espera al resto
+    auto esperarBOM = [this]() {
+        if (fin >= 3 || finArchivo) {
+            return false;
+        }
+        if (fin == 0) {
+            return true;
+        }
+        const unsigned char b0 = buffer[0];
+        if (b0 != 0xEF && b0 != 0xFE && b0 != 0xFF) {
+            return false;
+        }
+        return fin == 1 || (b0 == 0xEF && buffer[1] == 0xBB);
+    };
+    while (esperarBOM()) {
+        leerDisponible();
+    }
+    const std::vector<unsigned char> inicio(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(std::min<size_t>(fin, 3)));
+    if (text::tieneBOM_UTF16LE(inicio) || text::tieneBOM_UTF16BE(inicio)) {
+        codificacion = text::tieneBOM_UTF16BE(inicio) ? Codificacion::UTF16BE : Codificacion::UTF16LE;
+        pos = 2;
+    } else if (text::tieneBOM_UTF8(inicio)) {
+        pos = 3;
+    } else {
+        utf8SinConfirmar = true;
+    }
+}
+
+/**
+ * Agrega al buffer lo que el stream ya tiene listo, esperando solo si no
+ * tiene nada (al menos un byte o el fin)
+ * @return false si el stream terminó
+ */
+bool LectorLineas::leerDisponible() {
+    std::streambuf* sb = flujo->rdbuf();
+    std::streamsize listos = sb->in_avail();
+    if (listos <= 0) {
+        if (sb->sgetc() == std::char_traits<char>::eof()) {
+            finArchivo = true;
+            return false;
+        }
+        listos = std::max<std::streamsize>(sb->in_avail(), 1);
+    }
+    const size_t lugar = buffer.size() - fin;
+    const std::streamsize leidos = sb->sgetn(reinterpret_cast<char*>(buffer.data() + fin),
+                                             std::min<std::streamsize>(listos, static_cast<std::streamsize>(lugar)));
+    fin += static_cast<size_t>(std::max<std::streamsize>(leidos, 0));
+    return true;
+}
+
+/**
+ * Bytes que ocupa el siguiente codepoint según su primer byte (o unidad)
+ */
+size_t LectorLineas::bytesSiguiente() const {
+    if (pos == fin) {
+        return 1;
+    }
+    const unsigned char b = datos[pos];
+    switch (codificacion) {
+    case Codificacion::UTF8:
+        return b < 0xC0 ? 1 : b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+    case Codificacion::UTF16LE:
+    case Codificacion::UTF16BE: {
+        if (fin - pos < 2) {
+            return 2;
+        }
+        const unsigned char alto = codificacion == Codificacion::UTF16BE ? b : datos[pos + 1];
+        return alto >= 0xD8 && alto <= 0xDB ? 4 : 2;
+    }
+    case Codificacion::Latin1:
+        return 1;
+    }
+    return 1;
+}
+
+/**
+ * Sobre un stream: si hay bytes sin decodificar o que se pueden leer sin esperar
+ */
+bool LectorLineas::datosListos() const {
+    return pos < fin || (!finArchivo && flujo->rdbuf()->in_avail() > 0);
+}
+
+/**
+ * Mueve los bytes pendientes al inicio del buffer y completa con el siguiente trozo
+ * (solo cuando el archivo no se pudo proyectar en memoria)
+ * @return true si quedaron bytes por decodificar
+ */
+bool LectorLineas::rellenar() {
+    size_t pendientes = fin - pos;
+    if (pendientes > 0 && pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, pendientes);
+    }
+    pos = 0;
+    fin = pendientes;
+    if (flujo != nullptr) {
+        // Se espera solo por el codepoint que sigue, no por un trozo entero
+        while (fin < bytesSiguiente() && leerDisponible()) {
+        }
+        if (fin < kMargen && !finArchivo && flujo->rdbuf()->in_avail() > 0) {
+            leerDisponible();
+        }
+        return fin > 0;
+    }
+    if (!finArchivo) {
+        in.read(reinterpret_cast<char*>(buffer.data() + fin), static_cast<std::streamsize>(buffer.size() - fin));
+        fin += static_cast<size_t>(in.gcount());
+        if (!in) {
+            finArchivo = true;
+        }
+    }
+    return fin > 0;
+}
+
+/**
+ * Decodifica el siguiente codepoint según la codificación del archivo
+ * @return false al terminar el archivo o si se encontró una secuencia inválida
+ */
+bool LectorLineas::siguienteCodepoint(uint32_t& cp) {
+    if (fin - pos < kMargen && !finArchivo) {
+        rellenar();
+    }
+    if (pos == fin) {
+        return false;
+    }
+    const unsigned char* p = datos + pos;
+    size_t disponibles = fin - pos;
+
+    switch (codificacion) {
+    case Codificacion::Latin1:
+        // Cada byte Latin-1 es directamente su codepoint
+        cp = p[0];
+        pos += 1;
+        return true;
+
+    case Codificacion::UTF8: {
+        if (utf8SinConfirmar && p[0] >= 0x80) {
+            // Primer byte fuera de ASCII de un stream sin BOM: hasta acá UTF-8
+            // y Latin-1 coinciden. Si lo que ya llegó no es UTF-8 válido se
+            // sigue en Latin-1, como el fallback del modo archivo.
+            utf8SinConfirmar = false;
+            if (!esUTF8(p, disponibles, finArchivo)) {
+                codificacion = Codificacion::Latin1;
+                cp = p[0];
+                pos += 1;
+                return true;
+            }
+        }
+        int usados = text::decodificarUTF8(p, disponibles, cp);
+        if (usados <= 0) {
+            // Incompleto con el archivo terminado también es inválido
+            error = true;
+            return false;
+        }
+        pos += static_cast<size_t>(usados);
+        return true;
+    }
+
+    case Codificacion::UTF16LE:
+    case Codificacion::UTF16BE: {
+        bool be = codificacion == Codificacion::UTF16BE;
+        auto unidad = [be](const unsigned char* q) {
+            return be ? static_cast<uint16_t>(q[0] << 8 | q[1])
+                      : static_cast<uint16_t>(q[1] << 8 | q[0]);
+        };
+        if (disponibles < 2) {
+            error = true; // longitud impar
+            return false;
+        }
+        uint16_t u = unidad(p);
+        if (u >= 0xD800 && u <= 0xDBFF) {
+            // High surrogate: necesita un low surrogate a continuación
+            if (disponibles < 4) {
+                error = true;
+                return false;
+            }
+            uint16_t v = unidad(p + 2);
+            if (v < 0xDC00 || v > 0xDFFF) {
+                error = true;
+                return false;
+            }
+            cp = 0x10000 + (((u - 0xD800) << 10) | (v - 0xDC00));
+            pos += 4;
+        } else if (u >= 0xDC00 && u <= 0xDFFF) {
+            error = true; // Low surrogate sin high surrogate
+            return false;
+        } else {
+            cp = u;
+            pos += 2;
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+/**
+ * Camino rápido de leerBloque: copia a 'destino' los caracteres que no
+ * necesitan decodificación hasta el próximo '\n' o carácter especial
+ */
+void LectorLineas::copiarTramo(std::vector<uint32_t>& destino) {
+    uint32_t tramo[256];
+    while (true) {
+        size_t disponibles = fin - pos;
+        size_t copiados = 0;
+        size_t pedidos = 0;
+        if (codificacion == Codificacion::UTF16LE || codificacion == Codificacion::UTF16BE) {
+            pedidos = std::min<size_t>(disponibles / 2, 256);
+            copiados = text::copiarTramoUTF16(datos + pos, pedidos, codificacion == Codificacion::UTF16BE,
+                                              tramo, /*pararEnSalto=*/true);
+            pos += 2 * copiados;
+        } else {
+            pedidos = std::min<size_t>(disponibles, 256);
+            copiados = text::copiarTramoASCII(datos + pos, pedidos, tramo, /*pararEnSalto=*/true);
+            pos += copiados;
+        }
+        destino.insert(destino.end(), tramo, tramo + copiados);
+        if (copiados < pedidos || pedidos == 0) {
+            return;
+        }
+    }
+}
+
+bool LectorLineas::leerBloque(BloqueTexto& bloque, size_t maxCodepoints, size_t maxFilas) {
+    const size_t filasIniciales = bloque.filas();
+    const size_t cpsIniciales = bloque.codepoints.size();
+
+    while (!terminado && !error) {
+        size_t inicio = bloque.codepoints.size();
+        bool salto = false;
+        uint32_t cp = 0;
+        while (true) {
+            copiarTramo(bloque.codepoints);
+            if (!siguienteCodepoint(cp)) {
+                break;
+            }
+            if (cp == '\n') {
+                salto = true;
+                break;
+            }
+            bloque.codepoints.push_back(cp);
+        }
+        if (error) {
+            break;
+        }
+        if (salto) {
+            ++saltos;
+        } else {
+            // Fin del archivo: como std::getline, un último tramo vacío no es fila
+            terminado = true;
+            if (bloque.codepoints.size() == inicio) {
+                break;
+            }
+        }
+        // Eliminar retornos de carro si existen (caso Windows)
+        if (bloque.codepoints.size() > inicio && bloque.codepoints.back() == '\r') {
+            bloque.codepoints.pop_back();
+            ++retornos;
+        }
+        bloque.inicioFila.push_back(bloque.codepoints.size());
+
+        if (bloque.codepoints.size() - cpsIniciales >= maxCodepoints ||
+            bloque.filas() - filasIniciales >= maxFilas ||
+            (flujo != nullptr && !datosListos())) {
+            break;
+        }
+    }
+
+    if (error) {
+        // No entregamos filas a medias de un archivo que no se pudo decodificar
+        bloque.codepoints.resize(cpsIniciales);
+        bloque.inicioFila.resize(filasIniciales + 1);
+        return false;
+    }
+    return bloque.filas() > filasIniciales;
+}
+
+// ========== PERFIL DEL ARCHIVO (PRIMERA PASADA) ==========
+
+void MedidorPerfil::agregar(const BloqueTexto& bloque) {
+    for (size_t i = 0; i < bloque.filas(); ++i) {
+        columnas = std::max(columnas, bloque.anchoFila(i));
+    }
+    frecuencia.contar(bloque.codepoints);
+    filas += bloque.filas();
+    total += bloque.codepoints.size();
+}
+
+void MedidorPerfil::terminar(const LectorLineas& lector, PerfilTexto& perfil) {
+    frecuencia.sumar('\n', lector.saltosDeLinea());
+    frecuencia.sumar('\r', lector.retornosQuitados());
+    perfil.filas = filas;
+    perfil.columnas = columnas;
+    perfil.totalCodepoints = total + lector.saltosDeLinea() + lector.retornosQuitados();
+
+    // El fondo es el codepoint más frecuente sin contar ceros; ante empate,
+    // el menor (igual que analizarFrecuencia).
+    frecuencia.quitar(0);
+    perfil.simbolosDistintos = frecuencia.distintos();
+    perfil.masFrecuente = frecuencia.masFrecuente().first;
+}
+
+namespace {
+
+/**
+ * Recorre el archivo con la codificación indicada y acumula filas, columnas
+ * y frecuencias (incluidos los '\n' y '\r' que no quedan en las filas)
+ * @return false si el contenido no es válido para esa codificación
+ */
+bool medirArchivo(const std::string& ruta, PerfilTexto& perfil) {
+    LectorLineas lector(ruta, perfil.codificacion, perfil.offset);
+    if (!lector.abierto()) {
+        return false;
+    }
+
+    MedidorPerfil medidor;
+    BloqueTexto bloque;
+    while (lector.leerBloque(bloque, kTamTrozo, kTamTrozo)) {
+        medidor.agregar(bloque);
+        bloque.clear();
+    }
+    if (lector.huboError()) {
+        return false;
+    }
+    medidor.terminar(lector, perfil);
+    return true;
+}
+
+} // namespace
+
+// Lo que se sabe de la codificación sin leer más que el BOM.
+bool Normalizer::detectarCodificacion(const std::string& ruta, PerfilTexto& perfil) {
+    std::ifstream f(ruta, std::ios::binary);
+    if (!f) {
+        std::cerr << "No se pudo abrir el archivo: " << ruta << "\n";
+        return false;
+    }
+    std::vector<unsigned char> inicio(3, 0);
+    f.read(reinterpret_cast<char*>(inicio.data()), 3);
+    inicio.resize(static_cast<size_t>(f.gcount()));
+    f.close();
+
+    if (inicio.empty()) {
+        std::cerr << "Archivo vacío: " << ruta << "\n";
+        return false;
+    }
+
+    perfil = PerfilTexto();
+    if (text::tieneBOM_UTF16LE(inicio) || text::tieneBOM_UTF16BE(inicio)) {
+        perfil.codificacion = text::tieneBOM_UTF16BE(inicio) ? Codificacion::UTF16BE : Codificacion::UTF16LE;
+        perfil.offset = 2;
+    } else {
+        perfil.codificacion = Codificacion::UTF8;
+        perfil.offset = text::tieneBOM_UTF8(inicio) ? 3 : 0;
+    }
+    return true;
+}
+
+/**
+ * Versión en streaming de la detección de cargar_normalizado_UTF8
+ *
+ * ESTRATEGIA DE DETECCIÓN (la misma):
+ * 1. UTF-16 con BOM
+ * 2. UTF-8 (con o sin BOM), validando todo el archivo
+ * 3. Fallback a Latin-1 (ISO-8859-1)
+ */
+bool Normalizer::perfilarArchivo(const std::string& ruta, PerfilTexto& perfil) {
+    if (!detectarCodificacion(ruta, perfil)) {
+        return false;
+    }
+    if (perfil.codificacion != Codificacion::UTF8) {
+        if (!medirArchivo(ruta, perfil)) {
+            std::cerr << "Error decodificando UTF-16 en: " << ruta << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    if (medirArchivo(ruta, perfil)) {
+        return true;
+    }
+
+    perfil = PerfilTexto();
+    perfil.codificacion = Codificacion::Latin1;
+    perfil.offset = 0;
+    if (medirArchivo(ruta, perfil)) {
+        return true;
+    }
+
+    std::cerr << "No se pudo determinar la codificación del archivo: " << ruta << "\n";
+    return false;
+}
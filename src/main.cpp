@@ -6,8 +6,14 @@
 #include <filesystem>
 #include <tuple>
 #include <cctype>
+#include <memory>
+#include <chrono>
+#include <future>
+#include <set>
 
 #include "huffman/MatrixHuffman.hpp"
+#include "huffman/CompresorBloques.hpp"
+#include "huffman/PoolHilos.hpp"
 #include "lector.hpp"
 #include "dictionary/Dictionary.hpp"
 #include "dictionary/Decoder.hpp"
@@ -15,11 +21,27 @@
 using dictionary::Decoder;
 using dictionary::Dictionary;
 
-static int run_compression();
-static int run_decompression();
+// Lo que se lee de la línea de comandos además de las opciones de compresión.
+struct CliOptions {
+	std::string tablas;                 // --dict
+	bool lote = false;                  // compress/decompress: acepta lo de abajo
+	size_t trabajos = 0;                // --jobs: archivos a la vez (0 = todos los núcleos)
+	std::string dirSalida;              // --out-dir
+	bool forzar = false;                // --force: reemplaza salidas que ya existen
+	std::vector<std::string> entradas;  // rutas o patrones, más las de --list
+};
+
+static int run_compression(const huffman::OpcionesCompresion& opciones);
+static int run_decompression(size_t hilos);
+static int run_training(int argc, char** argv);
+static int run_batch(int argc, char** argv, bool comprimir);
+static int run_pipe(bool comprimir, const huffman::OpcionesCompresion& opciones);
 static void print_usage();
+static bool parse_options(int argc, char** argv, int first, huffman::OpcionesCompresion& opciones,
+                          CliOptions& cli);
+static bool load_shared_table(const std::string& ruta, huffman::OpcionesCompresion* opciones);
 
-static int run_compression() {
+static int run_compression(const huffman::OpcionesCompresion& opciones) {
     // =========================================================
     // PASO 1: INTERACCIÓN BÁSICA (Pedir archivo)
     // =========================================================
@@ -50,89 +72,37 @@ static int run_compression() {
     }
 
     // =========================================================
-    // PASO 2: NORMALIZACIÓN (Usando libreria 'lector')
+    // PASO 2: COMPRESIÓN POR BLOQUES (lector + huffman)
     // =========================================================
+    // El archivo se recorre en streaming: una pasada para medir la matriz y
+    // otra que escribe un frame con su propia tabla Huffman por bloque.
     std::cout << "[INFO] Cargando y normalizando texto...\n";
-    
-    UTF_8Text t = Normalizer::cargar_normalizado_UTF8(ruta);
-    
-    if (t.utf8.empty() && t.codepoints.empty()) {
-        std::cerr << "[ERROR] Fallo al cargar o normalizar el texto.\n";
-        return 1;
-    }
-
-    // Análisis previo necesario para obtener el dato más frecuente
-    auto codepoints_simplificados = t.simplificarCodepoints(t.codepoints);
-    auto [codepoint_mas_frecuente, frecuencia] = t.analizarFrecuencia(codepoints_simplificados);
-
-    // Obtener la estructura de matriz desde el Normalizer
-    auto resultado = Normalizer::CrearEntregarMatriz(t);
-    
-    int filas = std::get<0>(resultado);
-    int cols  = std::get<1>(resultado);
-    auto& datos_origen = std::get<2>(resultado);
-
-    std::cout << "[INFO] Matriz generada: " << filas << "x" << cols << " con " 
-              << datos_origen.size() << " elementos no vacios.\n";
-
-    // =========================================================
-    // PASO 3: INTEGRACIÓN CON HUFFMAN (Tu librería)
-    // =========================================================
-    std::cout << "--- Iniciando Codificacion Huffman ---\n";
-
-    // A. Definir el valor de fondo
-    std::string valorFondoStr = std::to_string(codepoint_mas_frecuente);
-    std::cout << "Valor de fondo (mas frecuente): '" << valorFondoStr << "'\n";
-
-    // B. Adaptar los datos
-    std::vector<huffman::Triplete> entradaHuffman;
-    entradaHuffman.reserve(datos_origen.size());
+    std::cout << "--- Iniciando Codificacion Huffman por bloques ---\n";
 
-    for (const auto& item : datos_origen) {
-        // Como 'item' es un vector<int>, usamos corchetes [], NO std::get
-        int f = item[0]; 
-        int c = item[1]; 
-        
-        // Convertimos el valor (int) a string para Huffman
-        std::string val = std::to_string(item[2]); 
-
-        // Filtramos el fondo
-        if (val != valorFondoStr) {
-            entradaHuffman.push_back({f, c, val});
-        }
+    std::string archivoSalida = "matriz_comprimida.bin";
+    huffman::EstadisticasCompresion stats;
+    try {
+        stats = huffman::comprimirArchivo(ruta, archivoSalida, opciones);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << "\n";
+        return 1;
     }
 
-    std::cout << "[INFO] Elementos dispersos finales a comprimir: " << entradaHuffman.size() << "\n";
-
-    // C. Ejecutar la compresión y exportación
-    // IMPORTANTE: Usamos extensión .bin para activar el modo binario
-    std::string archivoSalida = "matriz_comprimida.bin";
-    
-    auto diccionario = huffman::procesarMatrizYExportar(
-        entradaHuffman,
-        valorFondoStr,
-        filas,
-        cols,
-        archivoSalida
-    );
+    std::cout << "[INFO] Matriz generada: " << stats.filas << "x" << stats.columnas << "\n";
+    std::cout << "Valor de fondo (mas frecuente): '" << stats.fondo << "'\n";
 
     // =========================================================
-    // PASO 4: REPORTE FINAL
+    // PASO 3: REPORTE FINAL
     // =========================================================
     std::cout << "\n=== PROCESO TERMINADO CON EXITO ===\n";
-    std::cout << "1. Archivo generado: " << archivoSalida << "\n";
-    std::cout << "2. Simbolos unicos en diccionario: " << diccionario.size() << "\n";
-    
-    if (diccionario.find(valorFondoStr) != diccionario.end()) {
-        std::cout << "3. Codigo asignado al fondo ('" << valorFondoStr << "'): " << diccionario[valorFondoStr] << "\n";
-    } else {
-        std::cout << "3. El fondo fue optimizado (no presente en diccionario explicito).\n";
-    }
+    std::cout << "1. Archivo generado: " << archivoSalida << " (" << stats.bytesSalida << " bytes)\n";
+    std::cout << "2. Simbolos unicos en el texto: " << stats.simbolosDistintos << "\n";
+    std::cout << "3. Bloques escritos: " << stats.bloques << "\n";
 
     return 0;
 }
 
-static int run_decompression() {
+static int run_decompression(size_t hilos) {
     std::cout << "=== DECODIFICADOR HUFFMAN PARA MATRICES DISPERSAS ===\n";
     std::cout << "Ingrese la ruta del archivo .bin a decodificar [matriz_comprimida.bin]: ";
     std::string bin_path;
@@ -157,8 +127,7 @@ static int run_decompression() {
 
     try {
         std::cout << "[INFO] Decodificando '" << bin_path << "'...\n";
-        std::string decoded = Decoder::decodeFile(bin_path, dict);
-        Decoder::writeText(output_path, decoded);
+        Decoder::decodeToFile(bin_path, output_path, dict, hilos);
         std::cout << "[INFO] Matriz restaurada y guardada en '" << output_path << "'.\n";
         return 0;
     } catch (const std::exception& e) {
@@ -167,14 +136,418 @@ static int run_decompression() {
     }
 }
 
+// train <tablas> <muestra>... [--id <n>] [--max-code-length <n>]: arma una
+// tabla compartida con las muestras y la guarda en <tablas>.
+static int run_training(int argc, char** argv) {
+	std::string salida = argv[2];
+	std::vector<std::string> muestras;
+	long long id = 0;
+	long long longitudMaxima = 15;
+	for (int i = 3; i < argc; ++i) {
+		std::string arg = argv[i];
+		if ((arg == "--id" || arg == "--max-code-length") && i + 1 < argc) {
+			try {
+				long long n = std::stoll(argv[++i]);
+				if (n < 0 || (arg == "--id" && n > 0xFFFFFFFFLL) || (arg == "--max-code-length" && n > 32)) {
+					print_usage();
+					return 1;
+				}
+				if (arg == "--id") {
+					id = n;
+				} else {
+					longitudMaxima = n;
+				}
+			} catch (const std::exception&) {
+				print_usage();
+				return 1;
+			}
+		} else if (arg.rfind("--", 0) == 0) {
+			std::cerr << "Opcion desconocida: " << arg << "\n";
+			print_usage();
+			return 1;
+		} else {
+			muestras.push_back(arg);
+		}
+	}
+	if (muestras.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	try {
+		huffman::TablaCompartida tabla = huffman::entrenarTablaCompartida(
+			muestras, static_cast<uint32_t>(id), static_cast<int>(longitudMaxima));
+		huffman::guardarTablaCompartida(salida, tabla);
+		std::cout << "Tabla compartida " << tabla.id << " (hash " << std::hex << tabla.hash << std::dec
+		          << ", " << tabla.simbolos.size() << " simbolos) guardada en " << salida << "\n";
+		return 0;
+	} catch (const std::exception& e) {
+		std::cerr << "[ERROR] " << e.what() << "\n";
+		return 1;
+	}
+}
+
+// Carga la tabla compartida para el decoder y, si hay 'opciones', también
+// para el compresor.
+static bool load_shared_table(const std::string& ruta, huffman::OpcionesCompresion* opciones) {
+	try {
+		if (opciones != nullptr) {
+			opciones->tablaCompartida =
+				std::make_shared<const huffman::TablaCompartida>(huffman::cargarTablaCompartida(ruta));
+		}
+		Decoder::loadSharedTable(ruta);
+		return true;
+	} catch (const std::exception& e) {
+		std::cerr << "[ERROR] " << e.what() << "\n";
+		return false;
+	}
+}
+
+// '*' y '?' como en el shell, sobre un nombre de archivo.
+static bool matches_pattern(const char* patron, const char* nombre) {
+	const char* estrella = nullptr;  // última '*' del patrón y desde dónde cubre
+	const char* desde = nullptr;
+	while (*nombre != '\0') {
+		if (*patron == '?' || (*patron != '*' && *patron == *nombre)) {
+			++patron;
+			++nombre;
+		} else if (*patron == '*') {
+			estrella = patron++;
+			desde = nombre;
+		} else if (estrella != nullptr) {
+			patron = estrella + 1;
+			nombre = ++desde;
+		} else {
+			return false;
+		}
+	}
+	while (*patron == '*') {
+		++patron;
+	}
+	return *patron == '\0';
+}
+
+// Agrega 'entrada' a 'rutas'. Un nombre con '*' o '?' se expande a los
+// archivos de su directorio que coinciden (ordenados); así las listas que no
+// entran en la línea de comandos se pueden pasar entre comillas.
+static void expand_input(const std::string& entrada, std::vector<std::string>& rutas) {
+	namespace fs = std::filesystem;
+	const fs::path ruta(entrada);
+	const std::string nombre = ruta.filename().string();
+	if (nombre.find_first_of("*?") == std::string::npos) {
+		rutas.push_back(entrada);
+		return;
+	}
+	std::vector<std::string> encontradas;
+	std::error_code ec;
+	for (const auto& e : fs::directory_iterator(ruta.has_parent_path() ? ruta.parent_path() : fs::path("."), ec)) {
+		const std::string candidato = e.path().filename().string();
+		if (e.is_regular_file(ec) && matches_pattern(nombre.c_str(), candidato.c_str())) {
+			encontradas.push_back((ruta.parent_path() / candidato).string());
+		}
+	}
+	if (encontradas.empty()) {
+		// Sin coincidencias queda como ruta: falla al abrirla y sale en el resumen
+		rutas.push_back(entrada);
+		return;
+	}
+	std::sort(encontradas.begin(), encontradas.end());
+	rutas.insert(rutas.end(), encontradas.begin(), encontradas.end());
+}
+
+// Salida de un archivo del lote: <entrada>.bin al comprimir; al descomprimir
+// se le quita el .bin (o se agrega .txt si no lo tiene). Con 'dirSalida' va
+// ahí con el mismo nombre.
+static std::string output_path(const std::string& entrada, const std::string& dirSalida, bool comprimir) {
+	namespace fs = std::filesystem;
+	fs::path ruta(entrada);
+	std::string nombre = ruta.filename().string();
+	if (comprimir) {
+		nombre += ".bin";
+	} else if (ruta.extension() == ".bin") {
+		nombre = ruta.stem().string();
+	} else {
+		nombre += ".txt";
+	}
+	return ((dirSalida.empty() ? ruta.parent_path() : fs::path(dirSalida)) / nombre).string();
+}
+
+// Lo que pasó con un archivo del lote.
+struct BatchResult {
+	bool ok = false;
+	uint64_t bytesEntrada = 0;
+	uint64_t bytesSalida = 0;
+	std::string error;
+};
+
+// compress|decompress -: de stdin a stdout, frame por frame, para usarlo en
+// un pipe. Por stdout solo salen los datos; los errores van por stderr.
+static int run_pipe(bool comprimir, const huffman::OpcionesCompresion& opciones) {
+	try {
+		if (comprimir) {
+			huffman::comprimirFlujo(std::cin, std::cout, opciones);
+		} else {
+			Dictionary dict;
+			Decoder::decodeStream(std::cin, std::cout, dict);
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "[ERROR] " << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+// compress|decompress <entrada>... [--list <archivo>] [--out-dir <dir>]
+// [--jobs <n>] [opciones]: procesa todos los archivos sin preguntar nada,
+// varios a la vez en un pool de hilos, y al final muestra un resumen.
+static int run_batch(int argc, char** argv, bool comprimir) {
+	// Sin sincronizar con stdio, cin y cout van por bloques y el lector de un
+	// pipe ve lo que ya llegó sin esperar más (tiene que ser antes de usarlos)
+	std::ios::sync_with_stdio(false);
+	huffman::OpcionesCompresion opciones;
+	CliOptions cli;
+	cli.lote = true;
+	if (!parse_options(argc, argv, 2, opciones, cli)) {
+		print_usage();
+		return 1;
+	}
+	if (!cli.tablas.empty() && !load_shared_table(cli.tablas, comprimir ? &opciones : nullptr)) {
+		return 1;
+	}
+	if (std::find(cli.entradas.begin(), cli.entradas.end(), "-") != cli.entradas.end()) {
+		if (cli.entradas.size() != 1 || !cli.dirSalida.empty()) {
+			std::cerr << "[ERROR] '-' (stdin a stdout) va solo y sin --out-dir\n";
+			return 1;
+		}
+		return run_pipe(comprimir, opciones);
+	}
+	std::vector<std::string> entradas;
+	for (const std::string& entrada : cli.entradas) {
+		expand_input(entrada, entradas);
+	}
+	if (entradas.empty()) {
+		print_usage();
+		return 1;
+	}
+	if (!cli.dirSalida.empty()) {
+		std::error_code ec;
+		std::filesystem::create_directories(cli.dirSalida, ec);
+		if (ec) {
+			std::cerr << "[ERROR] No se pudo crear el directorio " << cli.dirSalida << ": " << ec.message() << "\n";
+			return 1;
+		}
+	}
+
+	// Dos entradas que van a la misma salida se pisarían entre hilos
+	std::vector<std::string> salidas;
+	std::set<std::string> vistas;
+	for (const std::string& entrada : entradas) {
+		salidas.push_back(output_path(entrada, cli.dirSalida, comprimir));
+		if (!vistas.insert(salidas.back()).second) {
+			std::cerr << "[ERROR] Dos entradas escriben en " << salidas.back() << "\n";
+			return 1;
+		}
+	}
+
+	const auto inicio = std::chrono::steady_clock::now();
+	std::vector<BatchResult> resultados(entradas.size());
+	{
+		huffman::PoolHilos pool(cli.trabajos);
+		std::vector<std::future<void>> pendientes;
+		pendientes.reserve(entradas.size());
+		for (size_t k = 0; k < entradas.size(); ++k) {
+			pendientes.push_back(pool.enviar([&, k]() {
+				BatchResult& r = resultados[k];
+				try {
+					// Descomprimir al lado del original lo pisaría, y la salida no
+					// siempre es idéntica (relleno, '\r' quitados)
+					std::error_code ec;
+					if (!cli.forzar && std::filesystem::exists(salidas[k], ec)) {
+						r.error = "ya existe " + salidas[k] + " (usar --force para reemplazarlo)";
+						return;
+					}
+					if (comprimir) {
+						r.bytesSalida = huffman::comprimirArchivo(entradas[k], salidas[k], opciones).bytesSalida;
+					} else {
+						Dictionary dict;
+						Decoder::decodeToFile(entradas[k], salidas[k], dict, opciones.hilos);
+						r.bytesSalida = std::filesystem::file_size(salidas[k]);
+					}
+					r.bytesEntrada = std::filesystem::file_size(entradas[k]);
+					r.ok = true;
+				} catch (const std::exception& e) {
+					r.error = e.what();
+				}
+			}));
+		}
+		for (auto& pendiente : pendientes) {
+			pendiente.get();
+		}
+	}
+	const double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+	size_t correctos = 0;
+	uint64_t totalEntrada = 0;
+	uint64_t totalSalida = 0;
+	for (size_t k = 0; k < entradas.size(); ++k) {
+		const BatchResult& r = resultados[k];
+		if (!r.ok) {
+			std::cerr << "[ERROR] " << entradas[k] << ": " << r.error << "\n";
+			continue;
+		}
+		++correctos;
+		totalEntrada += r.bytesEntrada;
+		totalSalida += r.bytesSalida;
+	}
+	std::cout << "=== RESUMEN ===\n";
+	std::cout << "Archivos: " << entradas.size() << " (" << correctos << " bien, " << entradas.size() - correctos
+	          << " con error)\n";
+	std::cout << "Bytes: " << totalEntrada << " -> " << totalSalida;
+	if (comprimir && totalEntrada > 0) {
+		std::cout << " (" << 100.0 * static_cast<double>(totalSalida) / static_cast<double>(totalEntrada) << "%)";
+	}
+	std::cout << "\n";
+	std::cout << "Tiempo: " << segundos << " s con " << huffman::PoolHilos::resolverHilos(cli.trabajos) << " hilos\n";
+	return correctos == entradas.size() ? 0 : 1;
+}
+
 static void print_usage() {
 	std::cout << "Usage:\n";
 	std::cout << "  Normal mode: run without arguments and follow prompts (process text normalization)\n";
+	std::cout << "    ./uncompressor [options]\n";
 	std::cout << "  Decode mode:\n";
-	std::cout << "    ./uncompressor decode <input.bin> <output.txt>\n";
+	std::cout << "    ./uncompressor decode <input.bin> <output.txt> [--threads <n>] [--dict <tables>]\n";
+	std::cout << "  Batch mode: many files at once, outputs next to the inputs (or in --out-dir)\n";
+	std::cout << "    ./uncompressor compress <input.txt>... [--list <file>] [--out-dir <dir>] [--jobs <n>] [--force] [options]\n";
+	std::cout << "    ./uncompressor decompress <input.bin>... [--list <file>] [--out-dir <dir>] [--jobs <n>] [--force]\n";
+	std::cout << "      inputs may be patterns like 'dir/*.txt'; --list reads one path per line\n";
+	std::cout << "      --jobs <n> files processed at once (default 0 = all cores); --threads applies per file\n";
+	std::cout << "      existing outputs are reported as errors and left untouched; --force replaces them\n";
+	std::cout << "      '-' as the only input reads stdin and writes stdout in a streaming format (for pipes);\n";
+	std::cout << "      frames go out as input arrives, --block-size bounds the delay and the memory;\n";
+	std::cout << "      without a BOM the text is UTF-8 unless what has arrived by its first non-ASCII\n";
+	std::cout << "      character is not valid UTF-8, then Latin-1\n";
+	std::cout << "  Train mode: build a shared Huffman table from sample texts\n";
+	std::cout << "    ./uncompressor train <tables> <sample.txt>... [--id <n>] [--max-code-length <n>]\n";
+	std::cout << "  Compression options:\n";
+	std::cout << "    --block-size <n>   characters per independent block (default 1048576)\n";
+	std::cout << "    --threads <n>      worker threads for block (de)compression (0 = all cores)\n";
+	std::cout << "    --ragged           store rows without padding them to the widest one\n";
+	std::cout << "    --background-runs  code runs of the background character as run lengths\n";
+	std::cout << "    --context-tables <n>  up to n Huffman tables chosen by the previous character (1-16, default 1)\n";
+	std::cout << "    --max-code-length <n>  longest Huffman code in bits, 1-32 (default 15, 0 = no limit)\n";
+	std::cout << "    --rans             entropy-code with rANS instead of Huffman codes\n";
+	std::cout << "    --interleaved      split each Huffman row group into 4 bitstreams decoded together\n";
+	std::cout << "                       (ignored with --rans, which already interleaves its states)\n";
+	std::cout << "    --lz <n>           LZ77 before Huffman, level 1-9 (overrides runs, contexts, rANS, interleaving)\n";
+	std::cout << "    --bwt              Burrows-Wheeler + move-to-front per block before Huffman (overrides --lz)\n";
+	std::cout << "    --dict <tables>    use a shared table from 'train' instead of per-block tables when it fits\n";
+	std::cout << "                       (overrides runs, contexts, rANS, --lz and --bwt)\n";
+}
+
+// Lee las opciones de compresión desde argv[first..]; el resto (--dict y,
+// con cli.lote, las entradas y las opciones del lote) queda en 'cli'.
+// Devuelve false si hay alguna opción desconocida o con un valor inválido.
+static bool parse_options(int argc, char** argv, int first, huffman::OpcionesCompresion& opciones,
+                          CliOptions& cli) {
+	for (int i = first; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (cli.lote && (arg == "--jobs" || arg == "--out-dir" || arg == "--list") && i + 1 < argc) {
+			std::string valor = argv[++i];
+			if (arg == "--out-dir") {
+				cli.dirSalida = valor;
+				continue;
+			}
+			if (arg == "--list") {
+				std::ifstream lista(valor);
+				if (!lista.is_open()) {
+					std::cerr << "No se pudo abrir la lista: " << valor << "\n";
+					return false;
+				}
+				for (std::string linea; std::getline(lista, linea);) {
+					if (!linea.empty() && linea.back() == '\r') {
+						linea.pop_back();
+					}
+					if (!linea.empty()) {
+						cli.entradas.push_back(linea);
+					}
+				}
+				continue;
+			}
+			try {
+				long long n = std::stoll(valor);
+				if (n < 0) {
+					return false;
+				}
+				cli.trabajos = static_cast<size_t>(n);
+			} catch (const std::exception&) {
+				return false;
+			}
+			continue;
+		}
+		if (cli.lote && arg.rfind("--", 0) != 0) {
+			cli.entradas.push_back(arg);
+			continue;
+		}
+		if (cli.lote && arg == "--force") {
+			cli.forzar = true;
+			continue;
+		}
+		if ((arg == "--block-size" || arg == "--threads" || arg == "--max-code-length" ||
+		     arg == "--context-tables" || arg == "--lz") && i + 1 < argc) {
+			try {
+				long long n = std::stoll(argv[++i]);
+				if (n < 0 || (n == 0 && arg == "--block-size") || (n > 32 && arg == "--max-code-length") ||
+				    (arg == "--context-tables" && (n < 1 || n > 16)) || (arg == "--lz" && (n < 1 || n > 9))) {
+					return false;
+				}
+				if (arg == "--block-size") {
+					opciones.tamBloque = static_cast<size_t>(n);
+				} else if (arg == "--context-tables") {
+					opciones.tablasContexto = static_cast<size_t>(n);
+				} else if (arg == "--max-code-length") {
+					opciones.longitudMaxima = static_cast<int>(n);
+				} else if (arg == "--lz") {
+					opciones.nivelLZ = static_cast<int>(n);
+				} else {
+					opciones.hilos = static_cast<size_t>(n);
+				}
+			} catch (const std::exception&) {
+				return false;
+			}
+		} else if (arg == "--ragged") {
+			opciones.filasIrregulares = true;
+		} else if (arg == "--background-runs") {
+			opciones.rachasFondo = true;
+		} else if (arg == "--rans") {
+			opciones.rans = true;
+		} else if (arg == "--interleaved") {
+			opciones.intercalado = true;
+		} else if (arg == "--bwt") {
+			opciones.bwt = true;
+		} else if (arg == "--dict" && i + 1 < argc) {
+			cli.tablas = argv[++i];
+		} else {
+			std::cerr << "Opcion desconocida: " << arg << "\n";
+			return false;
+		}
+	}
+	return true;
 }
 
 int main(int argc, char** argv) {
+	if (argc > 1 && std::string(argv[1]) == "train") {
+		if (argc < 4) {
+			print_usage();
+			return 1;
+		}
+		return run_training(argc, argv);
+	}
+
+	if (argc > 1 && (std::string(argv[1]) == "compress" || std::string(argv[1]) == "decompress")) {
+		return run_batch(argc, argv, std::string(argv[1]) == "compress");
+	}
+
 	if (argc > 1 && std::string(argv[1]) == "decode") {
 		if (argc < 4) {
 			print_usage();
@@ -183,11 +556,20 @@ int main(int argc, char** argv) {
 		std::string input_bin = argv[2];
 		std::string output_txt = argv[3];
 
+		huffman::OpcionesCompresion opciones;
+		CliOptions cli;
+		if (!parse_options(argc, argv, 4, opciones, cli)) {
+			print_usage();
+			return 1;
+		}
+		if (!cli.tablas.empty() && !load_shared_table(cli.tablas, nullptr)) {
+			return 1;
+		}
+
 		Dictionary dict;
 
 		try {
-			std::string decoded = Decoder::decodeFile(input_bin, dict);
-			Decoder::writeText(output_txt, decoded);
+			Decoder::decodeToFile(input_bin, output_txt, dict, opciones.hilos);
 			std::error_code ec;
 			if (std::filesystem::remove(input_bin, ec)) {
 				std::cout << "Binario temporal eliminado: " << input_bin << "\n";
@@ -202,6 +584,16 @@ int main(int argc, char** argv) {
 		}
 	}
 
+	huffman::OpcionesCompresion opciones;
+	CliOptions cli;
+	if (!parse_options(argc, argv, 1, opciones, cli)) {
+		print_usage();
+		return 1;
+	}
+	if (!cli.tablas.empty() && !load_shared_table(cli.tablas, &opciones)) {
+		return 1;
+	}
+
 	std::cout << "Seleccione una opcion:\n";
 	std::cout << "  1) Comprimir texto\n";
 	std::cout << "  2) Descomprimir binario\n";
@@ -211,8 +603,8 @@ int main(int argc, char** argv) {
 	char normalized = choice.empty() ? '1' : static_cast<char>(std::tolower(choice.front()));
 
 	if (normalized == '2' || normalized == 'd') {
-		return run_decompression();
+		return run_decompression(opciones.hilos);
 	}
 
-	return run_compression();
+	return run_compression(opciones);
 }